@@ -6,8 +6,8 @@
 
 [[nodiscard]] inline constexpr auto defer_func(auto f) {
 	struct defer {
-		decltype(f) f;
-		constexpr ~defer() noexcept { f(); }
+		decltype(f) fn;
+		constexpr ~defer() noexcept { fn(); }
 	};
 	return defer{ f };
 }
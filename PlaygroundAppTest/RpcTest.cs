@@ -1,8 +1,10 @@
 ﻿using PlaygroundLib;
 using ServerMethods = PlaygroundLib.ServerRpc.NativeMethods;
 using ClientMethods = PlaygroundLib.ClientRpc.NativeMethods;
+using StreamReply = PlaygroundLib.ClientRpc.StreamReply;
 
 using Moq;
+using System.Runtime.InteropServices;
 
 namespace PlaygroundAppTest;
 
@@ -20,13 +22,27 @@ public class RpcTest : IDisposable
         {
             passAndGetString = _callbacksMock.Object.PassAndGetString,
             passAndGetStringOut = _callbacksMock.Object.PassAndGetStringOut,
+            passAndGetBytes = EchoBytes,
         };
 
         Assert.True(ServerMethods.Initialize(_callbacks));
+
+        // The tests cover marshalling and the transport, not only the in-process shortcut
+        ClientMethods.ForceRpc(true);
     }
 
     public void Dispose() => ServerMethods.Terminate();
 
+    private static void EchoBytes(nint data, nuint size, out nint outData, out nuint outSize)
+    {
+        var buffer = new byte[size];
+        Marshal.Copy(data, buffer, 0, buffer.Length);
+
+        outData = Marshal.AllocCoTaskMem(buffer.Length);
+        Marshal.Copy(buffer, 0, outData, buffer.Length);
+        outSize = size;
+    }
+
     [Fact]
     public void TestPassAndGetString()
     {
@@ -42,4 +58,697 @@ public class RpcTest : IDisposable
         Assert.Equal(expectedResult, result);
         _callbacksMock.Verify(mock => mock.PassAndGetString(str), Times.Once());
     }
+
+    [Fact]
+    public void TestPassAndGetStringEx()
+    {
+        var str = "Status";
+        var expectedResult = $"Callback: {str}";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns(expectedResult);
+
+        Assert.Equal(0u, ClientMethods.PassAndGetStringEx(str, out var result));
+        Assert.Equal(expectedResult, result);
+
+        ServerMethods.Terminate();
+        ClientMethods.SetErrorLogRate(0);
+        try
+        {
+            var suppressed = ClientMethods.GetSuppressedErrors();
+
+            Assert.NotEqual(0u, ClientMethods.PassAndGetStringEx(str, out var failed));
+            Assert.Null(failed);
+            Assert.Equal(suppressed + 1, ClientMethods.GetSuppressedErrors());
+        }
+        finally
+        {
+            ClientMethods.SetErrorLogRate(10);
+            Assert.True(ServerMethods.Initialize(_callbacks));
+        }
+    }
+
+    [Fact]
+    public void TestPassAndGetStringTimeout()
+    {
+        var cancelledInCallback = new TaskCompletionSource<bool>();
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString("slow"))
+            .Returns(() =>
+            {
+                var start = Environment.TickCount64;
+                while (!ServerMethods.IsCallCancelled() && Environment.TickCount64 - start < 5000)
+                    Thread.Sleep(5);
+
+                cancelledInCallback.TrySetResult(ServerMethods.IsCallCancelled());
+                return "late";
+            });
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString("fast"))
+            .Returns("Callback: fast");
+
+        Assert.True(ClientMethods.GetDeadlineStats(out var before));
+
+        Assert.Equal(ClientMethods.ErrorTimeout, ClientMethods.PassAndGetString("slow", 50, out var timedOut));
+        Assert.Null(timedOut);
+        Assert.True(cancelledInCallback.Task.Wait(TimeSpan.FromSeconds(10)) && cancelledInCallback.Task.Result);
+
+        Assert.Equal(0u, ClientMethods.PassAndGetString("fast", 5000, out var result));
+        Assert.Equal("Callback: fast", result);
+
+        Assert.True(ClientMethods.GetDeadlineStats(out var after));
+        Assert.Equal(before.clientExpired + 1, after.clientExpired);
+        Assert.True(after.serverCancelled > before.serverCancelled);
+    }
+
+    [Fact]
+    public void TestPassAndGetStringTimeoutInProcess()
+    {
+        // Runs on the calling thread, nothing interrupts it
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString("slow"))
+            .Returns(() =>
+            {
+                Thread.Sleep(200);
+                return "late";
+            });
+
+        Assert.True(ClientMethods.GetDeadlineStats(out var before));
+        var inProcessBefore = ClientMethods.GetInProcessCalls();
+
+        ClientMethods.ForceRpc(false);
+        try
+        {
+            Assert.Equal(ClientMethods.ErrorTimeout, ClientMethods.PassAndGetString("slow", 50, out var timedOut));
+            Assert.Null(timedOut);
+            Assert.Equal(inProcessBefore + 1, ClientMethods.GetInProcessCalls());
+        }
+        finally
+        {
+            ClientMethods.ForceRpc(true);
+        }
+
+        Assert.True(ClientMethods.GetDeadlineStats(out var after));
+        Assert.Equal(before.clientExpired + 1, after.clientExpired);
+    }
+
+    // Nothing listens on it, every attempt fails with RpcServerUnavailable
+    private const string UnservedEndpoint = "playground_unserved";
+
+    [Fact]
+    public void TestPassAndGetStringRetry()
+    {
+        // The budget is shared by the process, a full one holds more than the two retries needed
+        ClientMethods.ResetRetries();
+
+        // Attempts 1 and 2 are retried, attempt 3 exhausts the policy
+        Assert.Equal(ClientMethods.RpcServerUnavailable, ClientMethods.PassAndGetStringRetry(UnservedEndpoint, "retry", 3, out var failed));
+        Assert.Null(failed);
+
+        Assert.True(ClientMethods.GetRetryStats(out var stats));
+        Assert.Equal(2ul, stats.retries);
+        Assert.Equal(1ul, stats.exhausted);
+        Assert.Equal(0ul, stats.overBudget);
+    }
+
+    [Fact]
+    public void TestPassAndGetStringRetryOverBudget()
+    {
+        ClientMethods.ResetRetries();
+        ClientMethods.SetRetryBudget(0);
+        try
+        {
+            // Calls no longer earn retries, these use up the burst of 10, two retries at a time
+            for (var i = 0; i < 5; ++i)
+                Assert.Equal(ClientMethods.RpcServerUnavailable, ClientMethods.PassAndGetStringRetry(UnservedEndpoint, "retry", 3, out _));
+
+            Assert.Equal(ClientMethods.RpcServerUnavailable, ClientMethods.PassAndGetStringRetry(UnservedEndpoint, "retry", 3, out var failed));
+            Assert.Null(failed);
+
+            Assert.True(ClientMethods.GetRetryStats(out var stats));
+            Assert.Equal(10ul, stats.retries);
+            Assert.Equal(5ul, stats.exhausted);
+            Assert.Equal(1ul, stats.overBudget);
+        }
+        finally
+        {
+            ClientMethods.ResetRetries();
+        }
+    }
+
+    [Fact]
+    public void TestPassAndGetStringInto()
+    {
+        var str = "Into";
+        var expectedResult = $"Callback: {str}";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns(expectedResult);
+
+        Span<byte> small = stackalloc byte[4];
+        Assert.Equal(ClientMethods.ErrorInsufficientBuffer, ClientMethods.PassAndGetStringInto(str, small, out var needed));
+        Assert.Equal((nuint)expectedResult.Length, needed);
+
+        var buffer = new byte[needed + 1];
+        Assert.Equal(0u, ClientMethods.PassAndGetStringInto(str, buffer, out var length));
+        Assert.Equal(needed, length);
+        Assert.Equal(0, buffer[(int)length]);
+        Assert.Equal(expectedResult, System.Text.Encoding.UTF8.GetString(buffer, 0, (int)length));
+
+        _callbacksMock.Verify(mock => mock.PassAndGetString(str), Times.Exactly(2));
+    }
+
+    private static void EchoBatch(nint requests, nint replies, nuint count)
+    {
+        for (var i = 0; i < (int)count; i++)
+        {
+            var request = Marshal.PtrToStructure<BatchRequest>(requests + i * Marshal.SizeOf<BatchRequest>());
+            var str = Marshal.PtrToStringUTF8(request.str, (int)request.size);
+            Marshal.WriteIntPtr(replies, i * nint.Size, Marshal.StringToCoTaskMemUTF8($"Batch: {str}"));
+        }
+    }
+
+    [Fact]
+    public void TestBatchCallback()
+    {
+        var callbacks = _callbacks with { passAndGetStringBatch = EchoBatch };
+
+        Assert.True(ServerMethods.Terminate());
+        Assert.True(ServerMethods.Initialize(callbacks));
+        Assert.True(ServerMethods.SetBatchOptions(50_000, 64));
+        Assert.True(ServerMethods.GetBatchStats(out var before));
+
+        const int count = 16;
+        var results = new string[count];
+        Parallel.For(0, count, new ParallelOptions { MaxDegreeOfParallelism = count }, i =>
+            results[i] = ClientMethods.PassAndGetString($"Request {i}"));
+
+        Assert.True(ServerMethods.GetBatchStats(out var after));
+        GC.KeepAlive(callbacks.passAndGetStringBatch);
+
+        for (var i = 0; i < count; i++)
+            Assert.Equal($"Batch: Request {i}", results[i]);
+
+        Assert.Equal((ulong)count, after.requests - before.requests);
+        Assert.True(after.batches - before.batches < count);
+        _callbacksMock.Verify(mock => mock.PassAndGetString(It.IsAny<string>()), Times.Never());
+    }
+
+    // "Gather: " and "!" around the request, split over several segments
+    private static readonly byte[] GatherPieces = "Gather: !"u8.ToArray();
+
+    private static void WriteSegment(nint segments, int index, nint data, nuint size) =>
+        Marshal.StructureToPtr(new ReplySegment { data = data, size = size }, segments + index * Marshal.SizeOf<ReplySegment>(), false);
+
+    private static nuint GatherReply(nint str, nint segments, nuint capacity, out nint context)
+    {
+        context = 0;
+
+        var length = 0;
+        while (Marshal.ReadByte(str, length) != 0)
+            length++;
+
+        if (length == 0 || capacity < 4)
+            return 0;
+
+        var pieces = GCHandle.Alloc(GatherPieces, GCHandleType.Pinned);
+        var piecesData = pieces.AddrOfPinnedObject();
+        var half = length / 2;
+
+        WriteSegment(segments, 0, piecesData, 8);
+        WriteSegment(segments, 1, str, (nuint)half);
+        WriteSegment(segments, 2, str + half, (nuint)(length - half));
+        WriteSegment(segments, 3, piecesData + 8, 1);
+
+        context = GCHandle.ToIntPtr(pieces);
+        return 4;
+    }
+
+    private static void ReleaseGatherReply(nint context)
+    {
+        if (context != 0)
+            GCHandle.FromIntPtr(context).Free();
+    }
+
+    [Fact]
+    public void TestGatherReply()
+    {
+        var callbacks = _callbacks with { passAndGetStringGather = GatherReply, releaseReply = ReleaseGatherReply };
+
+        Assert.True(ServerMethods.Terminate());
+        Assert.True(ServerMethods.Initialize(callbacks));
+
+        Assert.Equal("Gather: segmented!", ClientMethods.PassAndGetString("segmented"));
+        Assert.Equal("Gather: x!", ClientMethods.PassAndGetString("x"));
+
+        // No segments make an empty reply
+        Assert.Equal("", ClientMethods.PassAndGetString(""));
+
+        GC.KeepAlive(callbacks.passAndGetStringGather);
+        GC.KeepAlive(callbacks.releaseReply);
+        _callbacksMock.Verify(mock => mock.PassAndGetString(It.IsAny<string>()), Times.Never());
+    }
+
+    private static uint ReverseBytes(nint context, nint data, nuint size, out nint outData, out nuint outSize)
+    {
+        var buffer = new byte[size];
+        Marshal.Copy(data, buffer, 0, buffer.Length);
+        Array.Reverse(buffer);
+
+        outData = Marshal.AllocCoTaskMem(buffer.Length);
+        Marshal.Copy(buffer, 0, outData, buffer.Length);
+        outSize = size;
+        return 0;
+    }
+
+    [Fact]
+    public void TestInvokeMethod()
+    {
+        const uint methodId = 7;
+        byte[] data = [1, 2, 3, 4];
+
+        Assert.True(ServerMethods.RegisterMethod(methodId, ReverseBytes));
+        Assert.Equal([4, 3, 2, 1], ClientMethods.Invoke(methodId, data));
+
+        Assert.True(ServerMethods.UnregisterMethod(methodId));
+        Assert.False(ServerMethods.UnregisterMethod(methodId));
+        Assert.Null(ClientMethods.Invoke(methodId, data));
+        Assert.Null(ClientMethods.Invoke(methodId + 1, data));
+    }
+
+    [Fact]
+    public void TestInProcessCalls()
+    {
+        var str = "In process";
+        var expectedResult = $"Callback: {str}";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns(expectedResult);
+
+        var before = ClientMethods.GetInProcessCalls();
+        Assert.Equal(expectedResult, ClientMethods.PassAndGetString(str));
+        Assert.Equal(before, ClientMethods.GetInProcessCalls());
+
+        ClientMethods.ForceRpc(false);
+        try
+        {
+            Assert.Equal(expectedResult, ClientMethods.PassAndGetString(str));
+            Assert.Equal([3, 2, 1], ClientMethods.PassAndGetBytes([3, 2, 1]));
+            Assert.Equal(before + 2, ClientMethods.GetInProcessCalls());
+        }
+        finally
+        {
+            ClientMethods.ForceRpc(true);
+        }
+
+        _callbacksMock.Verify(mock => mock.PassAndGetString(str), Times.Exactly(2));
+    }
+
+    [Fact]
+    public void TestInProcessCallsOnlyToServedEndpoints()
+    {
+        var str = "Elsewhere";
+        var expectedResult = $"Callback: {str}";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns(expectedResult);
+
+        // Calls alternate between the replicas, and no one listens on the second one
+        string[] replicas = ["playground_server", "playground_elsewhere"];
+        var client = ClientMethods.HedgedClientCreate(replicas, (uint)replicas.Length, 10_000_000, 0.05);
+        Assert.NotEqual(0, client);
+
+        var before = ClientMethods.GetInProcessCalls();
+        ClientMethods.ForceRpc(false);
+        try
+        {
+            Assert.Equal(expectedResult, ClientMethods.HedgedClientPassAndGetString(client, str));
+            Assert.Equal(before + 1, ClientMethods.GetInProcessCalls());
+
+            Assert.Null(ClientMethods.HedgedClientPassAndGetString(client, str));
+            Assert.Equal(before + 1, ClientMethods.GetInProcessCalls());
+        }
+        finally
+        {
+            ClientMethods.ForceRpc(true);
+            ClientMethods.HedgedClientDestroy(client);
+        }
+
+        _callbacksMock.Verify(mock => mock.PassAndGetString(str), Times.Once());
+    }
+
+    [Fact]
+    public void TestCallMetrics()
+    {
+        var str = "Metrics";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns("Callback");
+
+        Assert.True(ClientMethods.GetCallMetrics(CallSide.Client, CallMethod.PassAndGetString, out var clientBefore));
+        Assert.True(ClientMethods.GetCallMetrics(CallSide.Server, CallMethod.PassAndGetString, out var serverBefore));
+
+        ClientMethods.PassAndGetString(str);
+
+        Assert.True(ClientMethods.GetCallMetrics(CallSide.Client, CallMethod.PassAndGetString, out var client));
+        Assert.True(ClientMethods.GetCallMetrics(CallSide.Server, CallMethod.PassAndGetString, out var server));
+
+        Assert.True(client.calls > clientBefore.calls);
+        Assert.True(server.calls > serverBefore.calls);
+        Assert.True(client.bytesOut >= clientBefore.bytesOut + (ulong)str.Length);
+        Assert.True(server.bytesIn >= serverBefore.bytesIn + (ulong)str.Length);
+        Assert.True(client.maxNs > 0);
+        Assert.True(client.p50Ns <= client.p99Ns && client.p99Ns <= client.maxNs);
+    }
+
+    [Fact]
+    public void TestTrace()
+    {
+        var str = "Traced";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns("Callback");
+
+        ClientMethods.TraceStart(0);
+        try
+        {
+            ClientMethods.PassAndGetString(str);
+        }
+        finally
+        {
+            ClientMethods.TraceStop();
+        }
+
+        using var trace = System.Text.Json.JsonDocument.Parse(ClientMethods.GetTraceJson());
+        var names = trace.RootElement
+            .GetProperty("traceEvents")
+            .EnumerateArray()
+            .Select(e => e.GetProperty("name").GetString())
+            .ToHashSet();
+
+        Assert.Contains("c_pass_and_get_string", names);
+        Assert.Contains("s_pass_and_get_string", names);
+        Assert.Contains("callback", names);
+    }
+
+    [Fact]
+    public void TestAllocStats()
+    {
+        var str = "Profiled";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns("Callback");
+
+        ClientMethods.SetAllocSampleInterval(1);
+        try
+        {
+            Assert.True(ClientMethods.GetAllocStats(AllocSite.ServerReply, out var before));
+
+            ClientMethods.PassAndGetString(str);
+
+            Assert.True(ClientMethods.GetAllocStats(AllocSite.ServerReply, out var after));
+            Assert.True(after.allocations > before.allocations);
+            Assert.True(after.bytes > before.bytes);
+            Assert.True(after.peakLiveBytes > 0);
+        }
+        finally
+        {
+            ClientMethods.SetAllocSampleInterval(0);
+        }
+    }
+
+    [Fact]
+    public void TestFlightRecorder()
+    {
+        var str = "Recorded";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns("Callback");
+
+        ClientMethods.PassAndGetString(str);
+
+        using var dump = System.Text.Json.JsonDocument.Parse(ClientMethods.FlightRecorderDump());
+        var recent = dump.RootElement.GetProperty("recent").EnumerateArray().ToList();
+
+        Assert.Contains(recent, e => e.GetProperty("side").GetString() == "client" && e.GetProperty("method").GetString() == "pass_and_get_string");
+        Assert.Contains(recent, e => e.GetProperty("side").GetString() == "server" && e.GetProperty("callback_ns").GetUInt64() > 0);
+    }
+
+    [Fact]
+    public void TestPassAndGetBytes()
+    {
+        byte[] data = [0x50, 0x47, 0x00, 0xFF, 0x00, 0x01];
+
+        var result = ClientMethods.PassAndGetBytes(data);
+
+        Assert.Equal(data, result);
+    }
+
+    [Fact]
+    public void TestPassAndGetStringDedup()
+    {
+        var str = new string('d', 64 * 1024);
+        var expectedResult = "Callback: dedup";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(str))
+            .Returns(expectedResult);
+
+        Assert.True(ClientMethods.GetDedupStats(out var before));
+
+        Assert.Equal(expectedResult, ClientMethods.PassAndGetStringDedup(str));
+        Assert.Equal(expectedResult, ClientMethods.PassAndGetStringDedup(str));
+
+        Assert.True(ClientMethods.GetDedupStats(out var after));
+        Assert.True(after.clientHits > before.clientHits);
+        _callbacksMock.Verify(mock => mock.PassAndGetString(str), Times.Exactly(2));
+    }
+
+    [Fact]
+    public void TestDeltaSession()
+    {
+        var first = string.Concat(Enumerable.Repeat("line of a growing log file\n", 200));
+        var second = first + "appended line\n";
+
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(It.IsAny<string>()))
+            .Returns((string str) => $"Callback: {str.Length}");
+
+        var session = ClientMethods.DeltaSessionCreate();
+        Assert.NotEqual(0, session);
+
+        try
+        {
+            Assert.Equal($"Callback: {first.Length}", ClientMethods.DeltaSessionPassAndGetString(session, first));
+            Assert.Equal($"Callback: {second.Length}", ClientMethods.DeltaSessionPassAndGetString(session, second));
+
+            Assert.True(ClientMethods.DeltaSessionGetStats(session, out var stats));
+            Assert.Equal(1ul, stats.fullSends);
+            Assert.Equal(1ul, stats.deltaSends);
+            Assert.True(stats.bytesSaved > 0);
+        }
+        finally
+        {
+            ClientMethods.DeltaSessionDestroy(session);
+        }
+
+        _callbacksMock.Verify(mock => mock.PassAndGetString(second), Times.Once());
+    }
+
+    [Fact]
+    public void TestShardPool()
+    {
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString(It.IsAny<string>()))
+            .Returns((string str) => $"Callback: {str}");
+
+        Assert.True(ServerMethods.Terminate());
+        Assert.True(ServerMethods.Initialize(_callbacks, 4));
+
+        var pool = ClientMethods.ShardPoolCreate(4);
+        Assert.NotEqual(0, pool);
+
+        try
+        {
+            for (ulong key = 0; key < 16; ++key)
+                Assert.Equal($"Callback: {key}", ClientMethods.ShardPoolPassAndGetString(pool, key, $"{key}"));
+
+            Assert.Equal("Callback: any", ClientMethods.ShardPoolPassAndGetString(pool, "any"));
+        }
+        finally
+        {
+            ClientMethods.ShardPoolDestroy(pool);
+        }
+
+        Assert.Equal(0, ClientMethods.ShardPoolCreate(0));
+    }
+
+    [Fact]
+    public void TestHedgedClient()
+    {
+        var calls = 0;
+
+        // The first attempt stalls until the duplicate wins and cancels it
+        _callbacksMock
+            .Setup(mock => mock.PassAndGetString("hedged"))
+            .Returns(() =>
+            {
+                if (Interlocked.Increment(ref calls) == 1)
+                {
+                    var start = Environment.TickCount64;
+                    while (!ServerMethods.IsCallCancelled() && Environment.TickCount64 - start < 5000)
+                        Thread.Sleep(5);
+                }
+
+                return "Callback: hedged";
+            });
+
+        Assert.True(ServerMethods.Terminate());
+        Assert.True(ServerMethods.Initialize(_callbacks, 2));
+
+        string[] replicas = ["playground_server_0", "playground_server_1"];
+        var client = ClientMethods.HedgedClientCreate(replicas, (uint)replicas.Length, 20_000, 0.5);
+        Assert.NotEqual(0, client);
+
+        try
+        {
+            var start = Environment.TickCount64;
+            Assert.Equal("Callback: hedged", ClientMethods.HedgedClientPassAndGetString(client, "hedged"));
+            Assert.True(Environment.TickCount64 - start < 5000);
+
+            Assert.True(ClientMethods.HedgedClientGetStats(client, out var stats));
+            Assert.Equal(1ul, stats.calls);
+            Assert.Equal(1ul, stats.hedges);
+            Assert.Equal(1ul, stats.hedgeWins);
+        }
+        finally
+        {
+            ClientMethods.HedgedClientDestroy(client);
+        }
+
+        Assert.Equal(0, ClientMethods.HedgedClientCreate(["playground_server_0"], 1, 0, 0.05));
+    }
+
+    [Fact]
+    public void TestMapFileContent()
+    {
+        var path = Path.Combine("Assets", "history.txt");
+        var expected = File.ReadAllBytes(path);
+
+        using var mapped = ClientMethods.MapFileContent(path);
+
+        Assert.NotNull(mapped);
+        Assert.Equal(expected, mapped.Content.ToArray());
+        Assert.Equal(System.Text.Encoding.UTF8.GetString(expected), ClientMethods.GetFileContent(path, false));
+    }
+
+    [Fact]
+    public void TestReadFiles()
+    {
+        var history = Path.Combine("Assets", "history.txt");
+        var large = Path.GetTempFileName();
+        try
+        {
+            var largeContent = new byte[3 * 1024 * 1024];
+            new Random(3).NextBytes(largeContent);
+            File.WriteAllBytes(large, largeContent);
+
+            var packed = ClientMethods.ReadFiles([history, Path.Combine("Assets", "missing.txt"), large], 4);
+
+            Assert.NotNull(packed);
+            Assert.Equal(3, packed.Files.Count);
+
+            Assert.True(packed.Files[0].Succeeded);
+            Assert.Equal(File.ReadAllBytes(history), packed.Files[0].Content.ToArray());
+
+            Assert.False(packed.Files[1].Succeeded);
+            Assert.True(packed.Files[1].Content.IsEmpty);
+
+            Assert.True(packed.Files[2].Succeeded);
+            Assert.Equal(largeContent, packed.Files[2].Content.ToArray());
+        }
+        finally
+        {
+            File.Delete(large);
+        }
+    }
+
+    [Fact]
+    public void TestStreamFileContent()
+    {
+        // Empty, a single partial chunk, and several chunks with a partial last one
+        foreach (var (fileSize, chunkSize) in new[] { (0, 64), (10, 64), (1000, 64) })
+        {
+            var path = Path.GetTempFileName();
+            try
+            {
+                var content = new byte[fileSize];
+                new Random(fileSize).NextBytes(content);
+                File.WriteAllBytes(path, content);
+
+                var received = new List<byte>();
+                var replies = 0;
+                StreamReply onReply = (data, size) =>
+                {
+                    var chunk = new byte[size];
+                    Marshal.Copy(data, chunk, 0, chunk.Length);
+                    received.AddRange(chunk);
+                    replies++;
+                };
+
+                Assert.True(ClientMethods.StreamFileContent(path, (nuint)chunkSize, 3, onReply, out var bytesSent));
+                Assert.Equal((ulong)fileSize, bytesSent);
+                Assert.Equal((fileSize + chunkSize - 1) / chunkSize, replies);
+                Assert.Equal(content, received.ToArray());
+            }
+            finally
+            {
+                File.Delete(path);
+            }
+        }
+    }
+
+    [Fact]
+    public void TestGetFileChecksum()
+    {
+        var path = Path.Combine("Assets", "history.txt");
+        var bytes = File.ReadAllBytes(path);
+
+        var expected = 0xFFFFFFFFu;
+        foreach (var b in bytes)
+            expected = System.Numerics.BitOperations.Crc32C(expected, b);
+        expected = ~expected;
+
+        Assert.Equal(System.Text.Encoding.UTF8.GetString(bytes), ClientMethods.GetFileContent(path, out uint checksum));
+        Assert.Equal(expected, checksum);
+
+        Assert.True(ClientMethods.GetFileChecksum(path, out var checksumOnly));
+        Assert.Equal(expected, checksumOnly);
+    }
+
+    [Fact]
+    public void TestGetFileContentCached()
+    {
+        var path = Path.Combine("Assets", "history.txt");
+        var expected = File.ReadAllText(path);
+
+        Assert.Equal(expected, ClientMethods.GetFileContentCached(path));
+        Assert.True(ClientMethods.GetFileCacheStats(out var before));
+
+        Assert.Equal(expected, ClientMethods.GetFileContentCached(path));
+        Assert.True(ClientMethods.GetFileCacheStats(out var after));
+
+        Assert.Equal(before.hits + 1, after.hits);
+        Assert.Equal(before.misses, after.misses);
+    }
 }
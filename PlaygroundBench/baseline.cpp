@@ -0,0 +1,284 @@
+#include "baseline.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+
+namespace
+{
+	constexpr int BASELINE_VERSION = 1;
+
+	[[nodiscard]] std::string escape(std::string_view text)
+	{
+		std::string out;
+		for (const char c : text)
+		{
+			if (c == '"' || c == '\\')
+				out += '\\';
+			out += c;
+		}
+		return out;
+	}
+
+	/// Just enough JSON for reading baselines back: objects, arrays, strings without unicode
+	/// escapes, numbers, literals. Unknown keys are skipped, so the format can grow.
+	class json_reader {
+	public:
+		explicit json_reader(std::string_view text)
+			: text_(text)
+		{
+		}
+
+		void expect(char c)
+		{
+			if (!consume(c))
+				fail(std::format("expected '{}'", c));
+		}
+
+		[[nodiscard]] bool consume(char c)
+		{
+			skip_space();
+			if (pos_ < text_.size() && text_[pos_] == c) {
+				++pos_;
+				return true;
+			}
+			return false;
+		}
+
+		[[nodiscard]] std::string read_string()
+		{
+			expect('"');
+
+			std::string out;
+			while (pos_ < text_.size() && text_[pos_] != '"')
+			{
+				if (text_[pos_] == '\\')
+					++pos_;
+				if (pos_ < text_.size())
+					out += text_[pos_++];
+			}
+
+			expect('"');
+			return out;
+		}
+
+		[[nodiscard]] double read_number()
+		{
+			skip_space();
+
+			double value = 0.0;
+			const auto [ptr, ec] = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), value);
+			if (ec != std::errc{})
+				fail("expected a number");
+
+			pos_ = static_cast<size_t>(ptr - text_.data());
+			return value;
+		}
+
+		/// Calls `on_item` for every element of an array
+		template <class Fn>
+		void read_array(Fn&& on_item)
+		{
+			expect('[');
+			if (consume(']'))
+				return;
+
+			do {
+				on_item();
+			} while (consume(','));
+
+			expect(']');
+		}
+
+		/// Calls `on_member` with every key of an object, which must consume the value
+		template <class Fn>
+		void read_object(Fn&& on_member)
+		{
+			expect('{');
+			if (consume('}'))
+				return;
+
+			do {
+				const auto key = read_string();
+				expect(':');
+				on_member(key);
+			} while (consume(','));
+
+			expect('}');
+		}
+
+		void skip_value()
+		{
+			skip_space();
+			if (pos_ >= text_.size())
+				fail("unexpected end");
+
+			switch (text_[pos_])
+			{
+			case '{':
+				read_object([&](const std::string&) { skip_value(); });
+				break;
+			case '[':
+				read_array([&] { skip_value(); });
+				break;
+			case '"':
+				std::ignore = read_string();
+				break;
+			case 't':
+			case 'f':
+			case 'n':
+				while (pos_ < text_.size() && std::isalpha(static_cast<unsigned char>(text_[pos_])))
+					++pos_;
+				break;
+			default:
+				std::ignore = read_number();
+				break;
+			}
+		}
+
+	private:
+		void skip_space()
+		{
+			while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+				++pos_;
+		}
+
+		[[noreturn]] void fail(const std::string& what) const
+		{
+			throw std::runtime_error(std::format("malformed baseline at offset {}: {}", pos_, what));
+		}
+
+		std::string_view text_;
+		size_t pos_ = 0;
+	};
+
+	[[nodiscard]] bench::result read_result(json_reader& reader)
+	{
+		bench::result r;
+
+		reader.read_object([&](const std::string& key) {
+			if (key == "name")
+				r.name = reader.read_string();
+			else if (key == "ns_per_op")
+				r.ns_per_op = reader.read_number();
+			else if (key == "iterations")
+				r.iterations = static_cast<size_t>(reader.read_number());
+			else if (key == "bytes_per_op")
+				r.bytes_per_op = static_cast<size_t>(reader.read_number());
+			else if (key == "samples")
+				reader.read_array([&] { r.samples.push_back(reader.read_number()); });
+			else
+				reader.skip_value();
+		});
+
+		return r;
+	}
+}
+
+namespace bench
+{
+	void save_baseline(const std::string& path, std::span<const result> results)
+	{
+		std::string out = std::format("{{\n  \"version\": {},\n  \"benchmarks\": [", BASELINE_VERSION);
+		auto it = std::back_inserter(out);
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const auto& r = results[i];
+			std::format_to(it, "{}\n    {{\"name\": \"{}\", \"ns_per_op\": {}, \"iterations\": {}, \"bytes_per_op\": {}, \"samples\": [",
+				i == 0 ? "" : ",", escape(r.name), r.ns_per_op, r.iterations, r.bytes_per_op);
+
+			for (size_t s = 0; s < r.samples.size(); ++s)
+				std::format_to(it, "{}{}", s == 0 ? "" : ", ", r.samples[s]);
+
+			out += "]}";
+		}
+
+		out += "\n  ]\n}\n";
+
+		std::ofstream file(path, std::ios::binary);
+		file << out;
+		if (!file)
+			throw std::runtime_error(std::format("cannot write baseline {}", path));
+	}
+
+	std::vector<result> load_baseline(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			throw std::runtime_error(std::format("cannot read baseline {}", path));
+
+		std::stringstream content;
+		content << file.rdbuf();
+		const auto text = content.str();
+
+		json_reader reader(text);
+		std::vector<result> results;
+		int version = 0;
+
+		reader.read_object([&](const std::string& key) {
+			if (key == "version")
+				version = static_cast<int>(reader.read_number());
+			else if (key == "benchmarks")
+				reader.read_array([&] { results.push_back(read_result(reader)); });
+			else
+				reader.skip_value();
+		});
+
+		if (version != BASELINE_VERSION)
+			throw std::runtime_error(std::format("baseline {} has version {}, expected {}", path, version, BASELINE_VERSION));
+
+		return results;
+	}
+
+	std::vector<comparison> compare(std::span<const result> baseline, std::span<const result> current, const compare_options& options)
+	{
+		const auto find = [](std::span<const result> results, const std::string& name) -> const result* {
+			const auto it = std::ranges::find(results, name, &result::name);
+			return it != results.end() ? &*it : nullptr;
+		};
+
+		std::vector<comparison> comparisons;
+
+		for (const auto& now : current)
+		{
+			comparison c{ .name = now.name, .current_ns = now.ns_per_op };
+
+			const auto* before = find(baseline, now.name);
+			if (before == nullptr || before->ns_per_op <= 0.0) {
+				c.outcome = verdict::added;
+				comparisons.push_back(std::move(c));
+				continue;
+			}
+
+			c.baseline_ns = before->ns_per_op;
+			c.ratio = now.ns_per_op / before->ns_per_op;
+			c.p_value = mann_whitney_p(before->samples, now.samples);
+
+			const double noise = median_absolute_deviation(before->samples) / before->ns_per_op;
+			c.threshold = std::max(options.min_change, options.noise_factor * noise);
+
+			if (c.p_value < options.max_p_value && c.ratio > 1.0 + c.threshold)
+				c.outcome = verdict::regressed;
+			else if (c.p_value < options.max_p_value && c.ratio < 1.0 - c.threshold)
+				c.outcome = verdict::improved;
+
+			comparisons.push_back(std::move(c));
+		}
+
+		for (const auto& before : baseline)
+		{
+			if (find(current, before.name) == nullptr)
+				comparisons.push_back({ .name = before.name, .baseline_ns = before.ns_per_op, .outcome = verdict::missing });
+		}
+
+		return comparisons;
+	}
+}
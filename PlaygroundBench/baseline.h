@@ -0,0 +1,53 @@
+#pragma once
+
+#include "bench.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+	/// Writes the results, samples included, as a JSON baseline. Throws `std::runtime_error`.
+	void save_baseline(const std::string& path, std::span<const result> results);
+
+	/// Reads a file written by `save_baseline`. Throws `std::runtime_error` when it is missing or malformed.
+	[[nodiscard]] std::vector<result> load_baseline(const std::string& path);
+
+	struct compare_options {
+		/// Smaller shifts of the median are never reported, whatever the statistics say
+		double min_change = 0.05;
+
+		/// A shift must also exceed this many relative median absolute deviations of the baseline
+		double noise_factor = 3.0;
+
+		/// Significance level of the rank test
+		double max_p_value = 0.01;
+	};
+
+	enum class verdict {
+		unchanged,
+		improved,
+		regressed,
+		added,
+		missing,
+	};
+
+	struct comparison {
+		std::string name;
+		double baseline_ns = 0.0;
+		double current_ns = 0.0;
+
+		/// Current over baseline median, above 1 is slower
+		double ratio = 0.0;
+		double p_value = 1.0;
+
+		/// The change needed to count, the larger of `min_change` and the baseline noise
+		double threshold = 0.0;
+		verdict outcome = verdict::unchanged;
+	};
+
+	/// A benchmark regressed when it got slower by more than the threshold and the rank test says the
+	/// samples differ beyond noise. Results are in the order of `current`, then benchmarks only in the baseline.
+	[[nodiscard]] std::vector<comparison> compare(std::span<const result> baseline, std::span<const result> current, const compare_options& options);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "bench_stats.h"
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bench
+{
+	struct result {
+		std::string name;
+
+		/// Median of the samples
+		double ns_per_op = 0.0;
+		size_t iterations = 0;
+
+		/// ns/op of every timed sample, the input of the regression test against a baseline
+		std::vector<double> samples;
+
+		/// Payload moved per operation, 0 when throughput is meaningless for the benchmark
+		size_t bytes_per_op = 0;
+	};
+
+	/// Every benchmark is timed as this many equal samples, enough for a rank test to tell noise from a shift
+	constexpr size_t SAMPLES = 15;
+
+	/// Keeps the optimizer from discarding a computed value
+	template <class T> requires std::is_arithmetic_v<T>
+	inline void do_not_optimize(T value)
+	{
+		static volatile T sink;
+		sink = value;
+	}
+
+	/// Keeps the optimizer from hoisting work on loop-invariant input out of the timed loop
+	template <class T>
+	[[nodiscard]] inline T* opaque(T* ptr)
+	{
+		static T* volatile holder;
+		holder = ptr;
+		return holder;
+	}
+
+	/// Runs `fn` for a warm-up pass and then `iterations` timed passes, split into `SAMPLES` samples
+	template <class Fn>
+	[[nodiscard]] result run(std::string_view name, size_t iterations, Fn&& fn)
+	{
+		for (size_t i = 0; i < iterations / 10 + 1; ++i)
+			fn();
+
+		const size_t per_sample = std::max<size_t>(iterations / SAMPLES, 1);
+
+		result r{ .name = std::string(name), .iterations = per_sample * SAMPLES };
+		r.samples.reserve(SAMPLES);
+
+		for (size_t s = 0; s < SAMPLES; ++s)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < per_sample; ++i)
+				fn();
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+
+			r.samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(per_sample));
+		}
+
+		r.ns_per_op = median(r.samples);
+		return r;
+	}
+
+	/// As `run`, with `fn(thread_index)` called from `threads` threads at once. ns/op is wall time
+	/// per operation of all threads together, i.e. inverse throughput.
+	template <class Fn>
+	[[nodiscard]] result run_concurrent(std::string_view name, size_t threads, size_t iterations, Fn&& fn)
+	{
+		const size_t per_thread = std::max<size_t>(iterations / SAMPLES / threads, 1);
+
+		result r{ .name = std::string(name), .iterations = per_thread * threads * SAMPLES };
+		r.samples.reserve(SAMPLES);
+
+		// Every round starts and ends on the barrier, the first one warms up
+		std::barrier sync(static_cast<std::ptrdiff_t>(threads + 1));
+		{
+			std::vector<std::jthread> workers;
+			workers.reserve(threads);
+			for (size_t t = 0; t < threads; ++t)
+			{
+				workers.emplace_back([&, t] {
+					for (size_t round = 0; round <= SAMPLES; ++round)
+					{
+						sync.arrive_and_wait();
+						for (size_t i = 0; i < per_thread; ++i)
+							fn(t);
+						sync.arrive_and_wait();
+					}
+				});
+			}
+
+			for (size_t round = 0; round <= SAMPLES; ++round)
+			{
+				sync.arrive_and_wait();
+				const auto start = std::chrono::steady_clock::now();
+				sync.arrive_and_wait();
+				const auto elapsed = std::chrono::steady_clock::now() - start;
+
+				if (round != 0)
+					r.samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(per_thread * threads));
+			}
+		}
+
+		r.ns_per_op = median(r.samples);
+		return r;
+	}
+
+	/// Text vs flat binary encoding of a structured record
+	std::vector<result> run_parse_benchmarks();
+
+	/// Connect cost, round trips, contention, large payloads, allocator churn and server dispatch, against a
+	/// server running in this process
+	std::vector<result> run_rpc_benchmarks();
+}
@@ -0,0 +1,117 @@
+#include "bench.h"
+
+#include "../PlaygroundRpcLib/flat_schema.h"
+
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+
+namespace
+{
+	struct record {
+		std::uint64_t id = 0;
+		std::string name;
+		std::string path;
+		std::uint64_t size = 0;
+		std::uint32_t flags = 0;
+		std::string payload;
+	};
+
+	/// The `key=value;` text packing our callers send through `pass_and_get_string`
+	std::string encode_text(const record& r)
+	{
+		return std::format("id={};name={};path={};size={};flags={};payload={};", r.id, r.name, r.path, r.size, r.flags, r.payload);
+	}
+
+	template <class T>
+	T parse_number(std::string_view text)
+	{
+		T value{};
+		std::from_chars(text.data(), text.data() + text.size(), value);
+		return value;
+	}
+
+	record decode_text(std::string_view text)
+	{
+		record r;
+		while (!text.empty())
+		{
+			const auto end = text.find(';');
+			const auto item = text.substr(0, end);
+			text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+			const auto eq = item.find('=');
+			if (eq == std::string_view::npos)
+				continue;
+
+			const auto key = item.substr(0, eq);
+			const auto value = item.substr(eq + 1);
+
+			if (key == "id") r.id = parse_number<std::uint64_t>(value);
+			else if (key == "name") r.name = value;
+			else if (key == "path") r.path = value;
+			else if (key == "size") r.size = parse_number<std::uint64_t>(value);
+			else if (key == "flags") r.flags = parse_number<std::uint32_t>(value);
+			else if (key == "payload") r.payload = value;
+		}
+		return r;
+	}
+
+	std::vector<std::byte> encode_flat(const record& r)
+	{
+		return playground::messages::record_builder{}
+			.id(r.id)
+			.name(r.name)
+			.path(r.path)
+			.size(r.size)
+			.flags(r.flags)
+			.payload(r.payload)
+			.finish();
+	}
+}
+
+namespace bench
+{
+	std::vector<result> run_parse_benchmarks()
+	{
+		constexpr size_t iterations = 1'000'000;
+
+		const record sample{
+			.id = 1234567890,
+			.name = "history.txt",
+			.path = R"(C:\Users\playground\Documents\Assets\history.txt)",
+			.size = 48213,
+			.flags = 0x11,
+			.payload = std::string(256, 'x'),
+		};
+
+		const auto text = encode_text(sample);
+		const auto flat = encode_flat(sample);
+
+		std::vector<result> results;
+
+		results.push_back(run("parse/text_decode", iterations, [&] {
+			const auto r = decode_text({ opaque(text.data()), text.size() });
+			do_not_optimize(r.id + r.size + r.flags + r.name.size() + r.path.size() + r.payload.size());
+		}));
+
+		results.push_back(run("parse/flat_view", iterations, [&] {
+			const auto view = playground::messages::record_view::from({ opaque(flat.data()), flat.size() });
+			do_not_optimize(view->id() + view->size() + view->flags() + view->name().size() + view->path().size() + view->payload().size());
+		}));
+
+		results.push_back(run("parse/text_encode", iterations, [&] {
+			const auto encoded = encode_text(sample);
+			do_not_optimize(encoded.size());
+		}));
+
+		results.push_back(run("parse/flat_encode", iterations, [&] {
+			const auto encoded = encode_flat(sample);
+			do_not_optimize(encoded.size());
+		}));
+
+		return results;
+	}
+}
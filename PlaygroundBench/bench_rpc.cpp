@@ -0,0 +1,138 @@
+#include "bench.h"
+
+#include "../PlaygroundRpcLib/call_trace.h"
+#include "../PlaygroundRpcLib/playground_client.h"
+#include "../PlaygroundRpcLib/playground_server.h"
+#include "../Common/defer.h"
+
+#include <array>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <Windows.h>
+
+namespace
+{
+	/// Client threads of the contention benchmarks, spread over one endpoint or all shards
+	constexpr size_t CONTENTION_THREADS = 16;
+	constexpr std::uint32_t CONTENTION_SHARDS = 8;
+
+	char* echo_string(const char* str)
+	{
+		const size_t size = std::strlen(str) + 1;
+		auto* reply = static_cast<char*>(CoTaskMemAlloc(size));
+		if (reply != nullptr)
+			std::memcpy(reply, str, size);
+		return reply;
+	}
+
+	void echo_bytes(const std::uint8_t* data, std::size_t size, std::uint8_t** out_data, std::size_t* out_size)
+	{
+		*out_data = static_cast<std::uint8_t*>(CoTaskMemAlloc(size));
+		*out_size = *out_data != nullptr ? size : 0;
+		if (*out_data != nullptr)
+			std::memcpy(*out_data, data, size);
+	}
+
+	void free_binding(handle_t handle)
+	{
+		playground::client::free_binding(handle);
+	}
+
+	void stop_server() noexcept
+	{
+		try {
+			playground::server::terminate();
+		}
+		catch (const std::exception&) {
+		}
+	}
+}
+
+namespace bench
+{
+	std::vector<result> run_rpc_benchmarks()
+	{
+		playground::server::initialize({ .pass_and_get_string = &echo_string, .pass_and_get_bytes = &echo_bytes }, CONTENTION_SHARDS);
+		defer(stop_server());
+
+		// The server runs in this process, the in-process shortcut is measured on its own below
+		playground::client::set_force_rpc(true);
+		defer(playground::client::set_force_rpc(false));
+
+		auto handle = playground::client::connect();
+		defer(free_binding(handle));
+
+		const std::string small(16, 'x');
+		const std::vector<std::byte> large(1024 * 1024, std::byte{ 'x' });
+
+		std::vector<result> results;
+
+		// The binding connects lazily, so the first call is part of the connect cost
+		results.push_back(run("rpc/connect", 300, [&] {
+			auto fresh = playground::client::connect();
+			defer(free_binding(fresh));
+			do_not_optimize(playground::client::pass_and_get_string(fresh, small).size());
+		}));
+
+		results.push_back(run("rpc/round_trip_small", 30'000, [&] {
+			do_not_optimize(playground::client::pass_and_get_string(handle, small).size());
+		}));
+
+		// The same calls from many threads, queued on one endpoint or spread over the shards
+		{
+			playground::client::shard_pool single(1);
+			results.push_back(run_concurrent("rpc/contention_1_endpoint", CONTENTION_THREADS, 100'000, [&](size_t) {
+				do_not_optimize(single.pass_and_get_string(small).size());
+			}));
+
+			playground::client::shard_pool sharded(CONTENTION_SHARDS);
+			results.push_back(run_concurrent("rpc/contention_8_endpoints", CONTENTION_THREADS, 100'000, [&](size_t) {
+				do_not_optimize(sharded.pass_and_get_string(small).size());
+			}));
+		}
+
+		playground::client::set_force_rpc(false);
+		results.push_back(run("rpc/round_trip_small_in_process", 300'000, [&] {
+			do_not_optimize(playground::client::pass_and_get_string(handle, small).size());
+		}));
+		playground::client::set_force_rpc(true);
+
+		auto large_result = run("rpc/round_trip_1mb", 300, [&] {
+			do_not_optimize(playground::client::pass_and_get_bytes(handle, large).size());
+		});
+		large_result.bytes_per_op = 2 * large.size();
+		results.push_back(std::move(large_result));
+
+		// Mixed sizes through the allocator every RPC buffer goes through, profiler included
+		constexpr std::array<size_t, 6> churn_sizes{ 16, 64, 256, 4096, 32, 65536 };
+		results.push_back(run("alloc/midl_user_churn", 1'000'000, [&, i = size_t{ 0 }]() mutable {
+			auto* ptr = MIDL_user_allocate(churn_sizes[i++ % churn_sizes.size()]);
+			do_not_optimize(reinterpret_cast<std::uintptr_t>(opaque(ptr)));
+			MIDL_user_free(ptr);
+		}));
+
+		// Server-side dispatch alone, without the transport: metrics, the callback and the reply copy
+		results.push_back(run("dispatch/pass_and_get_string", 300'000, [&] {
+			char* out_str = nullptr;
+			do_not_optimize(s_pass_and_get_string(nullptr, small.c_str(), &out_str));
+			MIDL_user_free(out_str);
+		}));
+
+		// One span as recorded around every call phase, with room for all of them so none is dropped
+		constexpr size_t span_iterations = 300'000;
+		playground::trace::start(span_iterations + span_iterations / 10 + 1);
+		results.push_back(run("trace/span", span_iterations, [&] {
+			playground::trace::span span("bench", 1);
+		}));
+		playground::trace::stop();
+
+		results.push_back(run("trace/span_stopped", 3'000'000, [&] {
+			playground::trace::span span("bench", 1);
+		}));
+
+		return results;
+	}
+}
@@ -0,0 +1,86 @@
+#include "bench_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+	double median(std::span<const double> values)
+	{
+		if (values.empty())
+			return 0.0;
+
+		std::vector<double> sorted(values.begin(), values.end());
+		std::ranges::sort(sorted);
+
+		const size_t middle = sorted.size() / 2;
+		return sorted.size() % 2 != 0 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2.0;
+	}
+
+	double median_absolute_deviation(std::span<const double> values)
+	{
+		const double center = median(values);
+
+		std::vector<double> deviations;
+		deviations.reserve(values.size());
+		for (const double value : values)
+			deviations.push_back(std::abs(value - center));
+
+		return median(deviations);
+	}
+
+	double mann_whitney_p(std::span<const double> a, std::span<const double> b)
+	{
+		if (a.empty() || b.empty())
+			return 1.0;
+
+		// (value, belongs to a)
+		std::vector<std::pair<double, bool>> all;
+		all.reserve(a.size() + b.size());
+		for (const double value : a)
+			all.emplace_back(value, true);
+		for (const double value : b)
+			all.emplace_back(value, false);
+
+		std::ranges::sort(all, {}, &std::pair<double, bool>::first);
+
+		const double n = static_cast<double>(all.size());
+		double rank_sum_a = 0.0;
+		double tie_term = 0.0;
+
+		for (size_t i = 0; i < all.size();)
+		{
+			size_t j = i;
+			while (j < all.size() && all[j].first == all[i].first)
+				++j;
+
+			// Tied values share the average of their ranks, which are 1-based
+			const double rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+			for (size_t k = i; k < j; ++k)
+			{
+				if (all[k].second)
+					rank_sum_a += rank;
+			}
+
+			const double t = static_cast<double>(j - i);
+			tie_term += t * t * t - t;
+			i = j;
+		}
+
+		const double n_a = static_cast<double>(a.size());
+		const double n_b = static_cast<double>(b.size());
+		const double u = rank_sum_a - n_a * (n_a + 1.0) / 2.0;
+		const double mean = n_a * n_b / 2.0;
+		const double variance = n_a * n_b / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+
+		if (variance <= 0.0)
+			return 1.0;
+
+		// With continuity correction
+		const double z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+		return std::erfc(z / std::numbers::sqrt2);
+	}
+}
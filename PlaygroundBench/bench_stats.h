@@ -0,0 +1,15 @@
+#pragma once
+
+#include <span>
+
+namespace bench
+{
+	[[nodiscard]] double median(std::span<const double> values);
+
+	/// Median absolute deviation from the median, a spread measure outliers do not inflate
+	[[nodiscard]] double median_absolute_deviation(std::span<const double> values);
+
+	/// Two-sided p-value of the Mann-Whitney U test, the probability of samples at least this far
+	/// apart in rank if both came from the same distribution. Normal approximation with tie correction.
+	[[nodiscard]] double mann_whitney_p(std::span<const double> a, std::span<const double> b);
+}
@@ -0,0 +1,139 @@
+#include "baseline.h"
+#include "bench.h"
+
+#include <charconv>
+#include <cstdio>
+#include <exception>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+
+// Native benchmarks and the performance regression check, run in Release configuration
+//
+//   PlaygroundBench                          runs everything and prints the results
+//   PlaygroundBench --save <baseline.json>   also stores them as the new baseline
+//   PlaygroundBench --compare <baseline.json> fails with exit code 1 when a benchmark regressed
+//   --filter <prefix>                        runs only benchmarks whose name starts with the prefix
+//   --threshold <percent>                    smallest change of the median that counts (5)
+
+namespace
+{
+	struct arguments {
+		std::string save;
+		std::string compare;
+		std::string filter;
+		bench::compare_options options;
+	};
+
+	[[nodiscard]] std::optional<arguments> parse_arguments(int argc, char** argv)
+	{
+		arguments args;
+
+		for (int i = 1; i + 1 < argc; i += 2)
+		{
+			const std::string_view name = argv[i];
+			const std::string_view value = argv[i + 1];
+
+			if (name == "--save")
+				args.save = value;
+			else if (name == "--compare")
+				args.compare = value;
+			else if (name == "--filter")
+				args.filter = value;
+			else if (name == "--threshold") {
+				double percent = 0.0;
+				const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), percent);
+				if (ec != std::errc{} || ptr != value.data() + value.size() || percent < 0.0)
+					return std::nullopt;
+				args.options.min_change = percent / 100.0;
+			}
+			else
+				return std::nullopt;
+		}
+
+		if (argc % 2 == 0)
+			return std::nullopt;
+
+		return args;
+	}
+
+	void append(std::vector<bench::result>& results, std::vector<bench::result> more, std::string_view filter)
+	{
+		for (auto& r : more)
+		{
+			if (r.name.starts_with(filter))
+				results.push_back(std::move(r));
+		}
+	}
+
+	[[nodiscard]] std::string_view to_string(bench::verdict verdict)
+	{
+		switch (verdict)
+		{
+		case bench::verdict::unchanged: return "ok";
+		case bench::verdict::improved: return "improved";
+		case bench::verdict::regressed: return "REGRESSED";
+		case bench::verdict::added: return "new";
+		case bench::verdict::missing: return "not run";
+		}
+		return {};
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const auto args = parse_arguments(argc, argv);
+	if (!args) {
+		std::println(stderr, "usage: PlaygroundBench [--save <baseline.json>] [--compare <baseline.json>] [--filter <prefix>] [--threshold <percent>]");
+		return 2;
+	}
+
+	try {
+		// Loaded first, a broken baseline should not cost a whole run
+		std::vector<bench::result> baseline;
+		if (!args->compare.empty())
+			baseline = bench::load_baseline(args->compare);
+
+		std::vector<bench::result> results;
+		append(results, bench::run_parse_benchmarks(), args->filter);
+		append(results, bench::run_rpc_benchmarks(), args->filter);
+
+		for (const auto& result : results)
+		{
+			std::print("{:<32} {:>12.1f} ns/op ({} iterations)", result.name, result.ns_per_op, result.iterations);
+			if (result.bytes_per_op != 0)
+				std::print(" {:>10.1f} MB/s", static_cast<double>(result.bytes_per_op) / result.ns_per_op * 1e3);
+			std::println("");
+		}
+
+		if (!args->save.empty())
+			bench::save_baseline(args->save, results);
+
+		if (args->compare.empty())
+			return 0;
+
+		std::println("");
+		std::println("{:<32} {:>12} {:>12} {:>8} {:>9} {:>10}  {}", "compared to baseline", "before ns", "now ns", "change", "threshold", "p", "");
+
+		bool regressed = false;
+		for (const auto& c : bench::compare(baseline, results, args->options))
+		{
+			regressed |= c.outcome == bench::verdict::regressed;
+
+			if (c.outcome == bench::verdict::added || c.outcome == bench::verdict::missing) {
+				std::println("{:<32} {:>12.1f} {:>12.1f} {:>8} {:>9} {:>10}  {}", c.name, c.baseline_ns, c.current_ns, "", "", "", to_string(c.outcome));
+				continue;
+			}
+
+			std::println("{:<32} {:>12.1f} {:>12.1f} {:>+7.1f}% {:>8.1f}% {:>10.2e}  {}",
+				c.name, c.baseline_ns, c.current_ns, (c.ratio - 1.0) * 100.0, c.threshold * 100.0, c.p_value, to_string(c.outcome));
+		}
+
+		return regressed ? 1 : 0;
+	}
+	catch (const std::exception& e) {
+		std::println(stderr, "Error: {}", e.what());
+		return 2;
+	}
+}
@@ -0,0 +1,33 @@
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged playground::alloc_profiler::site enum</summary>
+public enum AllocSite : uint
+{
+    RpcRuntime,
+    ServerReply,
+    CoTaskString,
+    CoTaskBytes,
+}
+
+/// <summary>Allocations per power-of-two size class, element i holds sizes in [2^i, 2^(i+1))</summary>
+[InlineArray(32)]
+public struct AllocSizeHistogram
+{
+    private ulong _element;
+}
+
+/// <summary>Mimics the unmanaged site_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct AllocStats
+{
+    public ulong allocations;
+    public ulong bytes;
+    public ulong frees;
+    public ulong liveBytes;
+    public ulong peakLiveBytes;
+    public ulong allocationsPerSecond;
+    public AllocSizeHistogram sizeHistogram;
+}
@@ -0,0 +1,12 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged batch_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct BatchStats
+{
+    public ulong batches;
+    public ulong requests;
+    public ulong fullBatches;
+}
@@ -0,0 +1,37 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged playground::metrics::side enum</summary>
+public enum CallSide : uint
+{
+    Client,
+    Server,
+}
+
+/// <summary>Mimics the unmanaged playground::metrics::method enum, one entry per RPC method</summary>
+public enum CallMethod : uint
+{
+    PassAndGetString,
+    PassAndGetBytes,
+    PassHashAndGetString,
+    PassHashedAndGetString,
+    PassDeltaAndGetString,
+    Invoke,
+}
+
+/// <summary>Mimics the unmanaged method_snapshot struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct CallMetrics
+{
+    public ulong calls;
+    public ulong errors;
+    public ulong bytesIn;
+    public ulong bytesOut;
+    public ulong totalNs;
+    public ulong maxNs;
+    public ulong p50Ns;
+    public ulong p90Ns;
+    public ulong p99Ns;
+    public ulong p999Ns;
+}
@@ -17,11 +17,59 @@ public delegate void PassAndGetStringOut(
     [MarshalAs(UnmanagedType.LPUTF8Str)] string str,
     [MarshalAs(UnmanagedType.LPUTF8Str)] out string outStr);
 
+/// <remarks>
+/// <paramref name="outData"/> must be allocated with <see cref="Marshal.AllocCoTaskMem"/>,
+/// the native side takes ownership of it.
+/// </remarks>
+public delegate void PassAndGetBytes(nint data, nuint size, out nint outData, out nuint outSize);
+
+/// <summary>Mimics the unmanaged reply_segment struct</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct ReplySegment
+{
+    public nint data;
+    public nuint size;
+}
+
+/// <remarks>
+/// Fills up to <paramref name="capacity"/> <see cref="ReplySegment"/> entries at <paramref name="segments"/>
+/// and returns their count. Segments may point into <paramref name="str"/> or into memory which stays pinned
+/// until <see cref="ReleaseReply"/> is called with <paramref name="context"/>.
+/// </remarks>
+public delegate nuint PassAndGetStringGather(nint str, nint segments, nuint capacity, out nint context);
+
+public delegate void ReleaseReply(nint context);
+
+/// <summary>Mimics the unmanaged batch_request struct</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct BatchRequest
+{
+    public nint str;
+    public nuint size;
+}
+
+/// <remarks>
+/// Answers <paramref name="count"/> <see cref="BatchRequest"/> entries at <paramref name="requests"/> in one
+/// transition, writing a <see cref="Marshal.StringToCoTaskMemUTF8"/> reply, or zero, to each of the
+/// <paramref name="count"/> pointers at <paramref name="replies"/>. The native side takes ownership of the replies.
+/// </remarks>
+public delegate void PassAndGetStringBatch(nint requests, nint replies, nuint count);
+
+/// <remarks>
+/// Handler of one method id of the generic invoke entry point. <paramref name="outData"/> must be allocated
+/// with <see cref="Marshal.AllocCoTaskMem"/>, the native side takes ownership of it. Returns 0 or a system error code.
+/// </remarks>
+public delegate uint MethodHandler(nint context, nint data, nuint size, out nint outData, out nuint outSize);
+
 [NativeMarshalling(typeof(CallbacksMarshaller))]
 public struct Callbacks
 {
     public PassAndGetString passAndGetString;
     public PassAndGetStringOut passAndGetStringOut;
+    public PassAndGetBytes? passAndGetBytes;
+    public PassAndGetStringGather? passAndGetStringGather;
+    public ReleaseReply? releaseReply;
+    public PassAndGetStringBatch? passAndGetStringBatch;
 }
 
 [CustomMarshaller(typeof(Callbacks), MarshalMode.ManagedToUnmanagedIn, typeof(CallbacksMarshaller))]
@@ -32,6 +80,10 @@ internal static class CallbacksMarshaller
     {
         internal nint passAndGetString;
         internal nint passAndGetStringOut;
+        internal nint passAndGetBytes;
+        internal nint passAndGetStringGather;
+        internal nint releaseReply;
+        internal nint passAndGetStringBatch;
     }
 
     internal static CallbacksUnmanaged ConvertToUnmanaged(Callbacks managed)
@@ -40,6 +92,16 @@ internal static class CallbacksMarshaller
         {
             passAndGetString = Marshal.GetFunctionPointerForDelegate(managed.passAndGetString),
             passAndGetStringOut = Marshal.GetFunctionPointerForDelegate(managed.passAndGetStringOut),
+            passAndGetBytes = GetFunctionPointerOrNull(managed.passAndGetBytes),
+            passAndGetStringGather = GetFunctionPointerOrNull(managed.passAndGetStringGather),
+            releaseReply = GetFunctionPointerOrNull(managed.releaseReply),
+            passAndGetStringBatch = GetFunctionPointerOrNull(managed.passAndGetStringBatch),
         };
     }
+
+    /// <summary>Optional callbacks are passed as null function pointers</summary>
+    private static nint GetFunctionPointerOrNull<TDelegate>(TDelegate? callback) where TDelegate : Delegate
+    {
+        return callback is null ? 0 : Marshal.GetFunctionPointerForDelegate(callback);
+    }
 }
@@ -0,0 +1,36 @@
+namespace PlaygroundLib.ClientRpc;
+
+/// <summary>Read-only view over a memory-mapped file, valid until disposed</summary>
+public sealed class MappedFileContent : IDisposable
+{
+    private readonly nint _data;
+    private readonly nuint _size;
+    private nint _mapping;
+
+    internal MappedFileContent(nint data, nuint size, nint mapping)
+    {
+        _data = data;
+        _size = size;
+        _mapping = mapping;
+    }
+
+    public long Length => (long)_size;
+
+    public unsafe ReadOnlySpan<byte> Content
+    {
+        get
+        {
+            ObjectDisposedException.ThrowIf(_mapping == 0, this);
+            return new ReadOnlySpan<byte>((void*)_data, checked((int)_size));
+        }
+    }
+
+    public void Dispose()
+    {
+        if (_mapping == 0)
+            return;
+
+        NativeMethods.UnmapFileContent(_mapping);
+        _mapping = 0;
+    }
+}
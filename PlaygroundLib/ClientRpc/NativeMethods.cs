@@ -2,6 +2,8 @@
 
 namespace PlaygroundLib.ClientRpc;
 
+public delegate void StreamReply(nint data, nuint size);
+
 public static partial class NativeMethods
 {
     private const string Library = "PlaygroundRpc";
@@ -11,9 +13,288 @@ public static partial class NativeMethods
         string filepath, 
         [MarshalAs(UnmanagedType.I1)] bool showMessageBox);
 
+    /// <param name="checksum">CRC-32C of the content, computed while copying it</param>
+    [LibraryImport(Library, EntryPoint = "get_file_content_checksum", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string GetFileContent(string filepath, out uint checksum);
+
+    /// <param name="checksum">CRC-32C of the content, computed without copying it</param>
+    [LibraryImport(Library, EntryPoint = "get_file_checksum", StringMarshalling = StringMarshalling.Utf8)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetFileChecksum(string filepath, out uint checksum);
+
+    [LibraryImport(Library, EntryPoint = "get_file_content_cached", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string GetFileContentCached(string filepath);
+
+    [LibraryImport(Library, EntryPoint = "set_file_cache_budget")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool SetFileCacheBudget(nuint budgetBytes);
+
+    [LibraryImport(Library, EntryPoint = "get_file_cache_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetFileCacheStats(out FileCacheStats stats);
+
+    [LibraryImport(Library, EntryPoint = "read_files", StringMarshalling = StringMarshalling.Utf8)]
+    private static partial nint ReadFiles(string[] filepaths, nuint count, nuint queueDepth);
+
+    /// <returns>Contents and per-file status of all files read concurrently, or null on failure</returns>
+    public static PackedFiles? ReadFiles(string[] filepaths, nuint queueDepth)
+    {
+        var packed = ReadFiles(filepaths, (nuint)filepaths.Length, queueDepth);
+        if (packed == 0)
+            return null;
+
+        try
+        {
+            return new PackedFiles(packed);
+        }
+        finally
+        {
+            Marshal.FreeCoTaskMem(packed);
+        }
+    }
+
+    [LibraryImport(Library, EntryPoint = "map_file_content", StringMarshalling = StringMarshalling.Utf8)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    private static partial bool MapFileContent(string filepath, out nint data, out nuint size, out nint mapping);
+
+    [LibraryImport(Library, EntryPoint = "unmap_file_content")]
+    internal static partial void UnmapFileContent(nint mapping);
+
+    /// <returns>A view over the whole file without copying it, or null on failure</returns>
+    public static MappedFileContent? MapFileContent(string filepath)
+    {
+        if (!MapFileContent(filepath, out var data, out var size, out var mapping))
+            return null;
+
+        return new MappedFileContent(data, size, mapping);
+    }
+
+    /// <summary>Keeps calls on NDR and the transport even while this process serves the endpoint</summary>
+    [LibraryImport(Library, EntryPoint = "client_force_rpc")]
+    public static partial void ForceRpc([MarshalAs(UnmanagedType.I1)] bool force);
+
+    [LibraryImport(Library, EntryPoint = "client_get_in_process_calls")]
+    public static partial ulong GetInProcessCalls();
+
     [LibraryImport(Library, EntryPoint = "pass_and_get_string_out", StringMarshalling = StringMarshalling.Utf8)]
     public static partial void PassAndGetString(string str, out string outStr);
 
     [LibraryImport(Library, EntryPoint = "pass_and_get_string", StringMarshalling = StringMarshalling.Utf8)]
     public static partial string PassAndGetString(string str);
+
+    /// <summary>Does not throw in the native library on failure, for loops where failures are frequent</summary>
+    /// <returns>0, or the system error code with <paramref name="outStr"/> null</returns>
+    [LibraryImport(Library, EntryPoint = "pass_and_get_string_ex", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial uint PassAndGetStringEx(string str, out string? outStr);
+
+    public const uint ErrorTimeout = 1460;
+
+    /// <summary>Cancels the call once <paramref name="timeoutMs"/> passed, the server skips it if it did not start yet</summary>
+    /// <returns>0, <see cref="ErrorTimeout"/>, or another system error code, with <paramref name="outStr"/> null on failure</returns>
+    [LibraryImport(Library, EntryPoint = "pass_and_get_string_timeout", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial uint PassAndGetString(string str, uint timeoutMs, out string? outStr);
+
+    public const uint RpcServerUnavailable = 1722;
+
+    /// <summary>Retries transient failures such as <see cref="RpcServerUnavailable"/> with jittered backoff, within the process-wide retry budget</summary>
+    /// <returns>0, or the system error code of the last attempt, with <paramref name="outStr"/> null on failure</returns>
+    [LibraryImport(Library, EntryPoint = "pass_and_get_string_retry", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial uint PassAndGetStringRetry(string str, uint maxAttempts, out string? outStr);
+
+    /// <summary>As <see cref="PassAndGetStringRetry(string, uint, out string?)"/>, on a binding to <paramref name="endpoint"/></summary>
+    [LibraryImport(Library, EntryPoint = "pass_and_get_string_retry_at", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial uint PassAndGetStringRetry(string endpoint, string str, uint maxAttempts, out string? outStr);
+
+    /// <summary>Share of calls made with retries which may be retried</summary>
+    [LibraryImport(Library, EntryPoint = "set_retry_budget")]
+    public static partial void SetRetryBudget(double ratio);
+
+    /// <summary>Refills the retry budget at the default ratio and zeroes <see cref="RetryStats"/></summary>
+    [LibraryImport(Library, EntryPoint = "reset_retries")]
+    public static partial void ResetRetries();
+
+    [LibraryImport(Library, EntryPoint = "get_retry_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetRetryStats(out RetryStats stats);
+
+    public const uint ErrorInsufficientBuffer = 122;
+
+    [LibraryImport(Library, EntryPoint = "pass_and_get_string_into", StringMarshalling = StringMarshalling.Utf8)]
+    private static partial uint PassAndGetStringInto(string str, Span<byte> buffer, nuint capacity, out nuint length);
+
+    /// <summary>Writes the UTF-8 reply, zero-terminated, into a caller-owned buffer without allocating</summary>
+    /// <returns>0, <see cref="ErrorInsufficientBuffer"/> with the reply length in <paramref name="length"/>
+    /// when the reply and its terminator do not fit, or another system error code</returns>
+    public static uint PassAndGetStringInto(string str, Span<byte> buffer, out nuint length) =>
+        PassAndGetStringInto(str, buffer, (nuint)buffer.Length, out length);
+
+    [LibraryImport(Library, EntryPoint = "pass_and_get_bytes")]
+    private static partial nint PassAndGetBytesNative(ReadOnlySpan<byte> data, nuint size, out nuint outSize);
+
+    public static byte[] PassAndGetBytes(ReadOnlySpan<byte> data)
+    {
+        var outData = PassAndGetBytesNative(data, (nuint)data.Length, out var outSize);
+        if (outData == 0)
+            return [];
+
+        try
+        {
+            var result = new byte[outSize];
+            Marshal.Copy(outData, result, 0, result.Length);
+            return result;
+        }
+        finally
+        {
+            Marshal.FreeCoTaskMem(outData);
+        }
+    }
+
+    [LibraryImport(Library, EntryPoint = "invoke_method")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    private static partial bool InvokeNative(uint methodId, ReadOnlySpan<byte> data, nuint size, out nint outData, out nuint outSize);
+
+    /// <returns>The reply of the handler registered under <paramref name="methodId"/>, or null on failure</returns>
+    public static byte[]? Invoke(uint methodId, ReadOnlySpan<byte> data)
+    {
+        if (!InvokeNative(methodId, data, (nuint)data.Length, out var outData, out var outSize))
+            return null;
+
+        if (outData == 0)
+            return [];
+
+        try
+        {
+            var result = new byte[outSize];
+            Marshal.Copy(outData, result, 0, result.Length);
+            return result;
+        }
+        finally
+        {
+            Marshal.FreeCoTaskMem(outData);
+        }
+    }
+
+    [LibraryImport(Library, EntryPoint = "pass_and_get_string_dedup", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string PassAndGetStringDedup(string str);
+
+    [LibraryImport(Library, EntryPoint = "get_dedup_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetDedupStats(out DedupStats stats);
+
+    [LibraryImport(Library, EntryPoint = "delta_session_create")]
+    public static partial nint DeltaSessionCreate();
+
+    [LibraryImport(Library, EntryPoint = "delta_session_destroy")]
+    public static partial void DeltaSessionDestroy(nint session);
+
+    [LibraryImport(Library, EntryPoint = "delta_session_pass_and_get_string", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string DeltaSessionPassAndGetString(nint session, string str);
+
+    [LibraryImport(Library, EntryPoint = "delta_session_get_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool DeltaSessionGetStats(nint session, out DeltaStats stats);
+
+    /// <returns>A pool over the shard endpoints of a server initialized with <paramref name="shards"/>, or 0 on failure</returns>
+    [LibraryImport(Library, EntryPoint = "shard_pool_create")]
+    public static partial nint ShardPoolCreate(uint shards);
+
+    [LibraryImport(Library, EntryPoint = "shard_pool_destroy")]
+    public static partial void ShardPoolDestroy(nint pool);
+
+    /// <summary>Calls with the same <paramref name="key"/> go to the same shard</summary>
+    [LibraryImport(Library, EntryPoint = "shard_pool_pass_and_get_string_keyed", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string ShardPoolPassAndGetString(nint pool, ulong key, string str);
+
+    /// <summary>Calls the shard with the fewest calls in flight</summary>
+    [LibraryImport(Library, EntryPoint = "shard_pool_pass_and_get_string", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string ShardPoolPassAndGetString(nint pool, string str);
+
+    /// <summary>Hedges calls over replica <paramref name="endpoints"/>: a duplicate goes to another one when no reply arrived within <paramref name="delayUs"/>, or the observed p95 latency when 0</summary>
+    /// <returns>The client, or 0 on failure</returns>
+    [LibraryImport(Library, EntryPoint = "hedged_client_create", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial nint HedgedClientCreate(string[] endpoints, uint count, uint delayUs, double maxHedgeRatio);
+
+    [LibraryImport(Library, EntryPoint = "hedged_client_destroy")]
+    public static partial void HedgedClientDestroy(nint client);
+
+    [LibraryImport(Library, EntryPoint = "hedged_client_pass_and_get_string", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string HedgedClientPassAndGetString(nint client, string str);
+
+    [LibraryImport(Library, EntryPoint = "hedged_client_get_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool HedgedClientGetStats(nint client, out HedgeStats stats);
+
+    [LibraryImport(Library, EntryPoint = "stream_file_content", StringMarshalling = StringMarshalling.Utf8)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    private static partial bool StreamFileContent(
+        string filepath,
+        nuint chunkSize,
+        nuint queueDepth,
+        nint onReply,
+        out ulong bytesSent);
+
+    public static bool StreamFileContent(string filepath, nuint chunkSize, nuint queueDepth, StreamReply? onReply, out ulong bytesSent)
+    {
+        var onReplyPtr = onReply is null ? 0 : Marshal.GetFunctionPointerForDelegate(onReply);
+        var result = StreamFileContent(filepath, chunkSize, queueDepth, onReplyPtr, out bytesSent);
+        GC.KeepAlive(onReply);
+        return result;
+    }
+
+    /// <param name="messagesPerSecond">0 silences the native error output, errors are still counted</param>
+    [LibraryImport(Library, EntryPoint = "set_error_log_rate")]
+    public static partial void SetErrorLogRate(uint messagesPerSecond);
+
+    [LibraryImport(Library, EntryPoint = "get_suppressed_errors")]
+    public static partial ulong GetSuppressedErrors();
+
+    [LibraryImport(Library, EntryPoint = "get_deadline_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetDeadlineStats(out DeadlineStats stats);
+
+    [LibraryImport(Library, EntryPoint = "get_call_metrics")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetCallMetrics(CallSide side, CallMethod method, out CallMetrics metrics);
+
+    [LibraryImport(Library, EntryPoint = "reset_call_metrics")]
+    public static partial void ResetCallMetrics();
+
+    /// <param name="eventsPerThread">0 for the default buffer size</param>
+    [LibraryImport(Library, EntryPoint = "trace_start")]
+    public static partial void TraceStart(nuint eventsPerThread);
+
+    [LibraryImport(Library, EntryPoint = "trace_stop")]
+    public static partial void TraceStop();
+
+    /// <returns>Chrome trace event JSON, viewable in chrome://tracing or Perfetto</returns>
+    [LibraryImport(Library, EntryPoint = "get_trace_json", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string GetTraceJson();
+
+    /// <param name="sampleInterval">0 turns sampling off, 1 records every allocation</param>
+    [LibraryImport(Library, EntryPoint = "set_alloc_sample_interval")]
+    public static partial void SetAllocSampleInterval(ulong sampleInterval);
+
+    [LibraryImport(Library, EntryPoint = "get_alloc_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetAllocStats(AllocSite site, out AllocStats stats);
+
+    [LibraryImport(Library, EntryPoint = "reset_alloc_stats")]
+    public static partial void ResetAllocStats();
+
+    [LibraryImport(Library, EntryPoint = "flight_recorder_set_slow_threshold")]
+    public static partial void FlightRecorderSetSlowThreshold(ulong thresholdNs);
+
+    /// <returns>JSON with the last calls and the last slow calls</returns>
+    [LibraryImport(Library, EntryPoint = "flight_recorder_dump", StringMarshalling = StringMarshalling.Utf8)]
+    public static partial string FlightRecorderDump();
+
+    [LibraryImport(Library, EntryPoint = "flight_recorder_arm", StringMarshalling = StringMarshalling.Utf8)]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool FlightRecorderArm(string directory, ulong p99ThresholdNs, uint windowCalls, uint cooldownSeconds);
+
+    [LibraryImport(Library, EntryPoint = "flight_recorder_disarm")]
+    public static partial void FlightRecorderDisarm();
+
+    [LibraryImport(Library, EntryPoint = "flight_recorder_auto_dumps")]
+    public static partial ulong FlightRecorderAutoDumps();
 }
@@ -0,0 +1,51 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib.ClientRpc;
+
+/// <summary>Result of a batch read, one buffer holding the content of every file</summary>
+public sealed class PackedFiles
+{
+    /// <summary>Mimics the unmanaged packed_files_header struct at a binary level</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    private struct Header
+    {
+        public uint count;
+        public uint reserved;
+        public ulong totalSize;
+    }
+
+    /// <summary>Mimics the unmanaged packed_file_entry struct at a binary level</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    private struct Entry
+    {
+        public uint status;
+        public uint reserved;
+        public ulong offset;
+        public ulong size;
+    }
+
+    public readonly record struct File(uint Status, ReadOnlyMemory<byte> Content)
+    {
+        public bool Succeeded => Status == 0;
+    }
+
+    public IReadOnlyList<File> Files { get; }
+
+    internal PackedFiles(nint packed)
+    {
+        var header = Marshal.PtrToStructure<Header>(packed);
+
+        var buffer = new byte[header.totalSize];
+        Marshal.Copy(packed, buffer, 0, buffer.Length);
+
+        var files = new File[header.count];
+        var entries = MemoryMarshal.Cast<byte, Entry>(buffer.AsSpan(Marshal.SizeOf<Header>(), files.Length * Marshal.SizeOf<Entry>()));
+        for (var i = 0; i < files.Length; i++)
+        {
+            var entry = entries[i];
+            files[i] = new File(entry.status, buffer.AsMemory(checked((int)entry.offset), checked((int)entry.size)));
+        }
+
+        Files = files;
+    }
+}
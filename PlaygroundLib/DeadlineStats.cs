@@ -0,0 +1,13 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged deadline_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct DeadlineStats
+{
+    public ulong clientExpired;
+    public ulong clientCancelled;
+    public ulong serverSkipped;
+    public ulong serverCancelled;
+}
@@ -0,0 +1,19 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged dedup_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct DedupStats
+{
+    public ulong clientHits;
+    public ulong clientMisses;
+    public ulong clientBytesSaved;
+
+    public ulong serverHits;
+    public ulong serverMisses;
+    public ulong serverEvictions;
+    public ulong serverEntries;
+    public ulong serverBytes;
+    public ulong serverBudget;
+}
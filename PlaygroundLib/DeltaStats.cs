@@ -0,0 +1,13 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged delta_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct DeltaStats
+{
+    public ulong deltaSends;
+    public ulong fullSends;
+    public ulong resyncs;
+    public ulong bytesSaved;
+}
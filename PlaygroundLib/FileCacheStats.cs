@@ -0,0 +1,16 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged file_cache_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct FileCacheStats
+{
+    public ulong hits;
+    public ulong misses;
+    public ulong revalidations;
+    public ulong evictions;
+    public ulong entries;
+    public ulong bytes;
+    public ulong budget;
+}
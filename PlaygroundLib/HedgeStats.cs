@@ -0,0 +1,13 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged hedge_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct HedgeStats
+{
+    public ulong calls;
+    public ulong hedges;
+    public ulong hedgeWins;
+    public ulong overBudget;
+}
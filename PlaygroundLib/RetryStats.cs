@@ -0,0 +1,12 @@
+using System.Runtime.InteropServices;
+
+namespace PlaygroundLib;
+
+/// <summary>Mimics the unmanaged retry_stats struct at a binary level</summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct RetryStats
+{
+    public ulong retries;
+    public ulong exhausted;
+    public ulong overBudget;
+}
@@ -1,3 +1,4 @@
+using System.Collections.Concurrent;
 using System.Runtime.InteropServices;
 
 namespace PlaygroundLib.ServerRpc;
@@ -10,7 +11,63 @@ public static partial class NativeMethods
     [return: MarshalAs(UnmanagedType.I1)]
     public static partial bool Initialize(Callbacks callbacks);
 
+    /// <summary>Also listens on <paramref name="shards"/> endpoints for <c>ShardPoolCreate</c> clients</summary>
+    [LibraryImport(Library, EntryPoint = "server_initialize_sharded")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool Initialize(Callbacks callbacks, uint shards);
+
     [LibraryImport(Library, EntryPoint = "server_terminate")]
     [return: MarshalAs(UnmanagedType.I1)]
     public static partial bool Terminate();
+
+    /// <summary>For callbacks polling while they work: the call passed its deadline or the client cancelled it</summary>
+    [LibraryImport(Library, EntryPoint = "server_is_call_cancelled")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool IsCallCancelled();
+
+    [LibraryImport(Library, EntryPoint = "server_set_content_store_budget")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool SetContentStoreBudget(nuint budgetBytes);
+
+    [LibraryImport(Library, EntryPoint = "server_set_batch_options")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool SetBatchOptions(uint windowMicroseconds, nuint maxBatchSize);
+
+    [LibraryImport(Library, EntryPoint = "server_get_batch_stats")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    public static partial bool GetBatchStats(out BatchStats stats);
+
+    /// <summary>Keeps registered handlers alive for as long as the native side may call them</summary>
+    private static readonly ConcurrentDictionary<uint, MethodHandler> s_methodHandlers = new();
+
+    [LibraryImport(Library, EntryPoint = "server_register_method")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    private static partial bool RegisterMethod(uint methodId, nint handler, nint context);
+
+    [LibraryImport(Library, EntryPoint = "server_unregister_method")]
+    [return: MarshalAs(UnmanagedType.I1)]
+    private static partial bool UnregisterMethodNative(uint methodId);
+
+    public static bool RegisterMethod(uint methodId, MethodHandler handler)
+    {
+        var previous = s_methodHandlers.TryGetValue(methodId, out var existing) ? existing : null;
+        s_methodHandlers[methodId] = handler;
+
+        if (RegisterMethod(methodId, Marshal.GetFunctionPointerForDelegate(handler), 0))
+            return true;
+
+        if (previous is null)
+            s_methodHandlers.TryRemove(methodId, out _);
+        else
+            s_methodHandlers[methodId] = previous;
+        return false;
+    }
+
+    /// <remarks>Returns once no call runs the handler any more. Called from inside the handler itself, it waits for the other calls only.</remarks>
+    public static bool UnregisterMethod(uint methodId)
+    {
+        var result = UnregisterMethodNative(methodId);
+        s_methodHandlers.TryRemove(methodId, out _);
+        return result;
+    }
 }
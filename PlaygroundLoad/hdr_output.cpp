@@ -0,0 +1,52 @@
+#include "hdr_output.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iterator>
+
+namespace load
+{
+	std::string to_percentile_distribution(const playground::latency_counts& counts)
+	{
+		constexpr double NS_PER_US = 1000.0;
+
+		std::string out = std::format("{:>12} {:>14} {:>10} {:>14}\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+		auto it = std::back_inserter(out);
+
+		double sum = 0.0;
+		double sum_of_squares = 0.0;
+		std::uint64_t seen = 0;
+
+		for (size_t i = 0; i < counts.buckets.size(); ++i)
+		{
+			const auto count = counts.buckets[i];
+			if (count == 0)
+				continue;
+
+			const double value = static_cast<double>(std::min(playground::histogram_buckets::upper_bound_of(i), counts.max)) / NS_PER_US;
+			sum += value * static_cast<double>(count);
+			sum_of_squares += value * value * static_cast<double>(count);
+
+			seen += count;
+			const double percentile = static_cast<double>(seen) / static_cast<double>(counts.total);
+
+			if (seen < counts.total)
+				std::format_to(it, "{:12.3f} {:2.12f} {:10} {:14.2f}\n", value, percentile, seen, 1.0 / (1.0 - percentile));
+			else
+				std::format_to(it, "{:12.3f} {:2.12f} {:10}\n", value, percentile, seen);
+		}
+
+		const double total = static_cast<double>(std::max<std::uint64_t>(counts.total, 1));
+		const double mean = sum / total;
+		const double deviation = std::sqrt(std::max(0.0, sum_of_squares / total - mean * mean));
+
+		std::format_to(it, "#[Mean    = {:12.3f}, StdDeviation   = {:12.3f}]\n", mean, deviation);
+		std::format_to(it, "#[Max     = {:12.3f}, Total count    = {:12}]\n", static_cast<double>(counts.max) / NS_PER_US, counts.total);
+		std::format_to(it, "#[Buckets = {:12}, SubBuckets     = {:12}]\n",
+			playground::histogram_buckets::MAX_BITS - playground::histogram_buckets::SUB_BUCKET_BITS + 1,
+			playground::histogram_buckets::SUB_BUCKETS);
+
+		return out;
+	}
+}
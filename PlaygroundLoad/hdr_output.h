@@ -0,0 +1,12 @@
+#pragma once
+
+#include "../PlaygroundRpcLib/latency_histogram.h"
+
+#include <string>
+
+namespace load
+{
+	/// Percentile distribution in the text layout of HdrHistogram's `outputPercentileDistribution`,
+	/// values in microseconds, so existing `.hgrm` plotters read it as-is. One row per non-empty bucket.
+	[[nodiscard]] std::string to_percentile_distribution(const playground::latency_counts& counts);
+}
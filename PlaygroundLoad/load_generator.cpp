@@ -0,0 +1,139 @@
+#include "load_generator.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	/// Sleeping alone overshoots by the timer resolution, which would show up as latency; the last
+	/// stretch before the intended time is spent yielding instead
+	constexpr auto SPIN_WINDOW = std::chrono::microseconds(500);
+
+	void wait_until(clock::time_point when)
+	{
+		if (const auto now = clock::now(); when - now > SPIN_WINDOW)
+			std::this_thread::sleep_until(when - SPIN_WINDOW);
+
+		while (clock::now() < when)
+			std::this_thread::yield();
+	}
+
+	struct connection_result {
+		playground::latency_histogram latency;
+		playground::latency_histogram service;
+		std::uint64_t sent = 0;
+		std::uint64_t errors = 0;
+		std::uint64_t late = 0;
+	};
+
+	/// Gaps between intended send times of one connection
+	class schedule {
+	public:
+		schedule(load::arrival_process arrival, double rate, std::uint64_t seed)
+			: arrival_(arrival), mean_(1e9 / rate), rng_(seed), gap_(rate / 1e9)
+		{
+		}
+
+		[[nodiscard]] std::chrono::nanoseconds next_gap()
+		{
+			const double ns = arrival_ == load::arrival_process::poisson ? gap_(rng_) : mean_;
+			return std::chrono::nanoseconds{ static_cast<std::int64_t>(ns) };
+		}
+
+	private:
+		load::arrival_process arrival_;
+		double mean_;
+		std::mt19937_64 rng_;
+		std::exponential_distribution<double> gap_;
+	};
+
+	void drive(load::connection& connection, const load::load_options& options, size_t index, size_t count,
+		clock::time_point start, connection_result& result)
+	{
+		const double rate = options.rate / static_cast<double>(count);
+		schedule gaps(options.arrival, rate, std::random_device{}());
+
+		const std::string payload(options.payload_size, 'x');
+		const auto recording_from = start + options.warmup;
+		const auto end = recording_from + options.duration;
+
+		// Constant-rate connections are staggered so their requests interleave evenly
+		auto intended = options.arrival == load::arrival_process::constant
+			? start + std::chrono::nanoseconds{ static_cast<std::int64_t>(1e9 / options.rate * static_cast<double>(index)) }
+			: start + gaps.next_gap();
+
+		for (; intended < end; intended += gaps.next_gap())
+		{
+			wait_until(intended);
+
+			const auto sent = clock::now();
+			bool ok = true;
+			try {
+				connection.pass_and_get_string(payload);
+			}
+			catch (const std::exception&) {
+				ok = false;
+			}
+			const auto done = clock::now();
+
+			if (intended < recording_from)
+				continue;
+
+			++result.sent;
+			if (!ok) {
+				++result.errors;
+				continue;
+			}
+
+			if (sent - intended > SPIN_WINDOW)
+				++result.late;
+
+			result.latency.record(static_cast<std::uint64_t>(std::chrono::nanoseconds(done - intended).count()));
+			result.service.record(static_cast<std::uint64_t>(std::chrono::nanoseconds(done - sent).count()));
+		}
+	}
+}
+
+namespace load
+{
+	load_result run_load(transport& transport, const load_options& options)
+	{
+		const size_t count = std::max<size_t>(options.connections, 1);
+
+		std::vector<std::unique_ptr<connection>> connections;
+		for (size_t i = 0; i < count; ++i)
+			connections.push_back(transport.connect());
+
+		std::vector<connection_result> results(count);
+
+		const auto start = clock::now();
+		{
+			std::vector<std::jthread> threads;
+			for (size_t i = 0; i < count; ++i)
+			{
+				threads.emplace_back([&, i] {
+					drive(*connections[i], options, i, count, start, results[i]);
+				});
+			}
+		}
+
+		load_result total;
+		total.elapsed = clock::now() - start - options.warmup;
+
+		for (const auto& result : results)
+		{
+			result.latency.add_to(total.latency);
+			result.service.add_to(total.service);
+			total.sent += result.sent;
+			total.errors += result.errors;
+			total.late += result.late;
+		}
+
+		return total;
+	}
+}
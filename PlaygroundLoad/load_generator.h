@@ -0,0 +1,51 @@
+#pragma once
+
+#include "transport.h"
+#include "../PlaygroundRpcLib/latency_histogram.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace load
+{
+	enum class arrival_process {
+		constant,
+		poisson,
+	};
+
+	struct load_options {
+		/// Requests per second over all connections
+		double rate = 1000.0;
+		std::chrono::nanoseconds duration = std::chrono::seconds(10);
+
+		/// Requests intended to start before the warm-up ends are sent but not recorded
+		std::chrono::nanoseconds warmup = std::chrono::seconds(1);
+
+		size_t connections = 16;
+		arrival_process arrival = arrival_process::poisson;
+		size_t payload_size = 64;
+	};
+
+	struct load_result {
+		/// From the intended send time of the schedule to completion, corrected for coordinated omission
+		playground::latency_counts latency;
+
+		/// From the actual send to completion, what a closed-loop tool would report
+		playground::latency_counts service;
+
+		std::uint64_t sent = 0;
+		std::uint64_t errors = 0;
+
+		/// Requests sent later than intended because their connection was still busy
+		std::uint64_t late = 0;
+
+		std::chrono::nanoseconds elapsed{};
+	};
+
+	/// Drives `pass_and_get_string` open-loop: every connection follows its own schedule at
+	/// `rate / connections` and never waits for the server to catch up before the next request is
+	/// due. A request whose time came while the previous one was outstanding is sent right away,
+	/// but its latency still counts from when it was due.
+	[[nodiscard]] load_result run_load(transport& transport, const load_options& options);
+}
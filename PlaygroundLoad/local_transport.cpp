@@ -0,0 +1,109 @@
+#include "transport.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <semaphore>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct request {
+		const std::string* str = nullptr;
+		std::string reply;
+		std::binary_semaphore done{ 0 };
+	};
+
+	class local_transport final : public load::transport {
+	public:
+		local_transport(size_t server_threads, load::service_time service)
+			: service_(service)
+		{
+			for (size_t i = 0; i < std::max<size_t>(server_threads, 1); ++i)
+				workers_.emplace_back([this](std::stop_token stop) { serve(stop); });
+		}
+
+		~local_transport() override
+		{
+			for (auto& worker : workers_)
+				worker.request_stop();
+			queued_.notify_all();
+		}
+
+		std::unique_ptr<load::connection> connect() override;
+
+		void call(request& r)
+		{
+			{
+				std::scoped_lock lock(mutex_);
+				queue_.push_back(&r);
+			}
+			queued_.notify_one();
+			r.done.acquire();
+		}
+
+	private:
+		void serve(std::stop_token stop)
+		{
+			std::mt19937_64 rng{ std::random_device{}() };
+
+			while (true)
+			{
+				request* r = nullptr;
+				{
+					std::unique_lock lock(mutex_);
+					if (!queued_.wait(lock, stop, [&] { return !queue_.empty(); }))
+						return;
+
+					r = queue_.front();
+					queue_.pop_front();
+				}
+
+				// Stands in for the stub callback: take the service time, then echo the request
+				load::spin_for(service_.sample(rng));
+				r->reply = *r->str;
+				r->done.release();
+			}
+		}
+
+		load::service_time service_;
+		std::mutex mutex_;
+		std::condition_variable_any queued_;
+		std::deque<request*> queue_;
+		std::vector<std::jthread> workers_;
+	};
+
+	class local_connection final : public load::connection {
+	public:
+		explicit local_connection(local_transport& transport)
+			: transport_(transport)
+		{
+		}
+
+		void pass_and_get_string(const std::string& str) override
+		{
+			request r;
+			r.str = &str;
+			transport_.call(r);
+		}
+
+	private:
+		local_transport& transport_;
+	};
+
+	std::unique_ptr<load::connection> local_transport::connect()
+	{
+		return std::make_unique<local_connection>(*this);
+	}
+}
+
+namespace load
+{
+	std::unique_ptr<transport> make_local_transport(size_t server_threads, service_time service)
+	{
+		return std::make_unique<local_transport>(server_threads, service);
+	}
+}
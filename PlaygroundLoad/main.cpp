@@ -0,0 +1,233 @@
+#include "hdr_output.h"
+#include "load_generator.h"
+#include "service_time.h"
+#include "transport.h"
+
+#include <charconv>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// Open-loop load generator for pass_and_get_string, run in Release configuration
+
+namespace
+{
+	struct arguments {
+		load::load_options load;
+		load::service_time service;
+		std::string transport = "local";
+		size_t server_threads = 8;
+		size_t streams = 4;
+		std::string hdr_out;
+		bool help = false;
+	};
+
+	void print_usage()
+	{
+		std::println("usage: PlaygroundLoad [options]");
+		std::println("  --rate <requests/s>          arrival rate over all connections (1000)");
+		std::println("  --duration <s>               recorded run time (10)");
+		std::println("  --warmup <s>                 unrecorded run time before it (1)");
+		std::println("  --connections <n>            concurrent connections (16)");
+		std::println("  --arrival poisson|constant   inter-arrival distribution (poisson)");
+		std::println("  --payload <bytes>            request size (64)");
+		std::println("  --service <spec>             stub callback time in us: none, const:US, uniform:MIN:MAX,");
+		std::println("                               exp:MEAN, lognormal:MEDIAN:SIGMA, bimodal:FAST:SLOW:P (none)");
+		std::println("  --transport local|mux|rpc    in-process queue, the same behind multiplexed streams,");
+		std::println("                               or ncalrpc on Windows (local)");
+		std::println("  --server-threads <n>         server pool size of the local and mux transports (8)");
+		std::println("  --streams <n>                byte streams the mux transport's connections share (4)");
+		std::println("  --hdr-out <prefix>           writes <prefix>.corrected.hgrm and <prefix>.uncorrected.hgrm");
+		std::println("  --help, -h                   prints this and exits");
+	}
+
+	template <class T>
+	[[nodiscard]] std::optional<T> parse_number(std::string_view text)
+	{
+		T value{};
+		const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+		if (ec != std::errc{} || ptr != text.data() + text.size() || value < T{})
+			return std::nullopt;
+		return value;
+	}
+
+	[[nodiscard]] std::optional<std::chrono::nanoseconds> parse_seconds(std::string_view text)
+	{
+		const auto seconds = parse_number<double>(text);
+		if (!seconds)
+			return std::nullopt;
+		return std::chrono::nanoseconds{ static_cast<std::int64_t>(*seconds * 1e9) };
+	}
+
+	[[nodiscard]] std::optional<arguments> parse_arguments(int argc, char** argv)
+	{
+		arguments args;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view name = argv[i];
+			if (name == "--help" || name == "-h") {
+				args.help = true;
+				return args;
+			}
+
+			if (i + 1 >= argc) {
+				std::println(stderr, "missing value: {}", name);
+				return std::nullopt;
+			}
+
+			const std::string_view value = argv[++i];
+
+			bool ok = true;
+			if (name == "--rate") {
+				const auto rate = parse_number<double>(value);
+				ok = rate && *rate > 0.0;
+				args.load.rate = rate.value_or(0.0);
+			}
+			else if (name == "--duration") {
+				const auto duration = parse_seconds(value);
+				ok = duration.has_value();
+				args.load.duration = duration.value_or(std::chrono::nanoseconds{});
+			}
+			else if (name == "--warmup") {
+				const auto warmup = parse_seconds(value);
+				ok = warmup.has_value();
+				args.load.warmup = warmup.value_or(std::chrono::nanoseconds{});
+			}
+			else if (name == "--connections") {
+				const auto connections = parse_number<size_t>(value);
+				ok = connections && *connections > 0;
+				args.load.connections = connections.value_or(0);
+			}
+			else if (name == "--arrival") {
+				ok = value == "poisson" || value == "constant";
+				args.load.arrival = value == "constant" ? load::arrival_process::constant : load::arrival_process::poisson;
+			}
+			else if (name == "--payload") {
+				const auto payload = parse_number<size_t>(value);
+				ok = payload.has_value();
+				args.load.payload_size = payload.value_or(0);
+			}
+			else if (name == "--service") {
+				const auto service = load::service_time::parse(value);
+				ok = service.has_value();
+				args.service = service.value_or(load::service_time{});
+			}
+			else if (name == "--transport") {
+				ok = value == "local" || value == "mux" || value == "rpc";
+				args.transport = value;
+			}
+			else if (name == "--server-threads") {
+				const auto threads = parse_number<size_t>(value);
+				ok = threads && *threads > 0;
+				args.server_threads = threads.value_or(0);
+			}
+			else if (name == "--streams") {
+				const auto streams = parse_number<size_t>(value);
+				ok = streams && *streams > 0;
+				args.streams = streams.value_or(0);
+			}
+			else if (name == "--hdr-out") {
+				args.hdr_out = value;
+			}
+			else {
+				ok = false;
+			}
+
+			if (!ok) {
+				std::println(stderr, "invalid option: {} {}", name, value);
+				return std::nullopt;
+			}
+		}
+
+		return args;
+	}
+
+	void print_percentiles(std::string_view title, const playground::latency_counts& counts)
+	{
+		std::println("{} (us)", title);
+		for (const double percentile : { 50.0, 90.0, 99.0, 99.9, 99.99, 100.0 })
+			std::println("  {:>7}%  {:>12.1f}", percentile, static_cast<double>(counts.value_at_percentile(percentile)) / 1000.0);
+	}
+
+	[[nodiscard]] bool write_file(const std::string& path, const std::string& content)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << content;
+		return static_cast<bool>(file);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const auto args = parse_arguments(argc, argv);
+	if (!args) {
+		print_usage();
+		return 2;
+	}
+
+	if (args->help) {
+		print_usage();
+		return 0;
+	}
+
+#ifdef _WIN32
+	// The default timer resolution would make every sleep of the schedule overshoot
+	std::ignore = timeBeginPeriod(1);
+#endif
+
+	try {
+		std::unique_ptr<load::transport> transport;
+#ifdef _WIN32
+		if (args->transport == "rpc")
+			transport = load::make_rpc_transport(args->service);
+#endif
+		if (args->transport == "local")
+			transport = load::make_local_transport(args->server_threads, args->service);
+		if (args->transport == "mux")
+			transport = load::make_mux_transport(args->server_threads, args->streams, args->service);
+
+		if (transport == nullptr) {
+			std::println(stderr, "transport {} is not available on this platform", args->transport);
+			return 2;
+		}
+
+		std::println("{} transport, {} connections, {:.0f} requests/s {}, service time {}",
+			args->transport, args->load.connections, args->load.rate,
+			args->load.arrival == load::arrival_process::poisson ? "poisson" : "constant",
+			args->service.describe());
+
+		const auto result = load::run_load(*transport, args->load);
+
+		const double seconds = std::chrono::duration<double>(result.elapsed).count();
+		std::println("sent {} in {:.1f} s ({:.0f} requests/s), {} errors, {} sent late",
+			result.sent, seconds, static_cast<double>(result.sent) / seconds, result.errors, result.late);
+
+		print_percentiles("latency from intended send time", result.latency);
+		print_percentiles("latency from actual send time, uncorrected", result.service);
+
+		if (!args->hdr_out.empty()
+			&& (!write_file(args->hdr_out + ".corrected.hgrm", load::to_percentile_distribution(result.latency))
+				|| !write_file(args->hdr_out + ".uncorrected.hgrm", load::to_percentile_distribution(result.service))))
+		{
+			std::println(stderr, "cannot write {}.*.hgrm", args->hdr_out);
+			return 1;
+		}
+	}
+	catch (const std::exception& e) {
+		std::println(stderr, "Error: {}", e.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,394 @@
+#include "mux.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+	using load::mux::duplex_stream;
+	using load::mux::frame_header;
+
+	static_assert(std::is_trivially_copyable_v<frame_header> && sizeof(frame_header) == 16);
+
+	/// One direction of an in-memory pipe
+	class pipe_buffer {
+	public:
+		void write(std::span<const std::byte> data)
+		{
+			{
+				std::scoped_lock lock(mutex_);
+				if (closed_)
+					throw std::runtime_error{ "stream is closed" };
+
+				// Consumed bytes are dropped once they make up most of the buffer
+				if (offset_ == data_.size()) {
+					data_.clear();
+					offset_ = 0;
+				}
+				else if (offset_ > 64 * 1024 && offset_ * 2 > data_.size()) {
+					data_.erase(data_.begin(), data_.begin() + static_cast<std::ptrdiff_t>(offset_));
+					offset_ = 0;
+				}
+
+				data_.insert(data_.end(), data.begin(), data.end());
+			}
+			readable_.notify_one();
+		}
+
+		size_t read(std::span<std::byte> buffer)
+		{
+			std::unique_lock lock(mutex_);
+			readable_.wait(lock, [&] { return closed_ || offset_ < data_.size(); });
+
+			if (closed_)
+				return 0;
+
+			const size_t n = std::min(buffer.size(), data_.size() - offset_);
+			std::memcpy(buffer.data(), data_.data() + offset_, n);
+			offset_ += n;
+			return n;
+		}
+
+		void close() noexcept
+		{
+			{
+				std::scoped_lock lock(mutex_);
+				closed_ = true;
+			}
+			readable_.notify_all();
+		}
+
+	private:
+		std::mutex mutex_;
+		std::condition_variable readable_;
+		std::vector<std::byte> data_;
+		size_t offset_ = 0;
+		bool closed_ = false;
+	};
+
+	class memory_end final : public duplex_stream {
+	public:
+		memory_end(std::shared_ptr<pipe_buffer> in, std::shared_ptr<pipe_buffer> out)
+			: in_(std::move(in)), out_(std::move(out))
+		{
+		}
+
+		~memory_end() override
+		{
+			close();
+		}
+
+		void write(std::span<const std::byte> data) override
+		{
+			out_->write(data);
+		}
+
+		size_t read(std::span<std::byte> buffer) override
+		{
+			return in_->read(buffer);
+		}
+
+		void close() noexcept override
+		{
+			in_->close();
+			out_->close();
+		}
+
+	private:
+		std::shared_ptr<pipe_buffer> in_;
+		std::shared_ptr<pipe_buffer> out_;
+	};
+
+	/// False when the stream ended cleanly before the first byte
+	[[nodiscard]] bool read_exact(duplex_stream& stream, std::span<std::byte> buffer)
+	{
+		for (size_t filled = 0; filled < buffer.size();)
+		{
+			const auto n = stream.read(buffer.subspan(filled));
+			if (n == 0) {
+				if (filled == 0)
+					return false;
+				throw std::runtime_error{ "stream ended within a frame" };
+			}
+
+			filled += n;
+		}
+
+		return true;
+	}
+
+	/// False when the stream ended cleanly between frames
+	[[nodiscard]] bool read_frame(duplex_stream& stream, frame_header& header, std::string& payload)
+	{
+		std::array<std::byte, sizeof(frame_header)> raw;
+		if (!read_exact(stream, raw))
+			return false;
+
+		header = std::bit_cast<frame_header>(raw);
+		if (header.size > load::mux::MAX_FRAME_SIZE)
+			throw std::runtime_error{ "frame is too large" };
+
+		payload.resize(header.size);
+		if (!read_exact(stream, std::as_writable_bytes(std::span{ payload })))
+			throw std::runtime_error{ "stream ended within a frame" };
+
+		return true;
+	}
+
+	/// Callers serialize writes to a stream, frames must not interleave
+	void write_frame(duplex_stream& stream, const frame_header& header, std::string_view payload)
+	{
+		stream.write(std::as_bytes(std::span{ &header, 1 }));
+		stream.write(std::as_bytes(std::span{ payload }));
+	}
+}
+
+namespace load::mux
+{
+	std::pair<std::unique_ptr<duplex_stream>, std::unique_ptr<duplex_stream>> make_memory_pipe()
+	{
+		auto forward = std::make_shared<pipe_buffer>();
+		auto backward = std::make_shared<pipe_buffer>();
+
+		return {
+			std::make_unique<memory_end>(backward, forward),
+			std::make_unique<memory_end>(forward, backward),
+		};
+	}
+
+	client::client(std::unique_ptr<duplex_stream> stream)
+		: stream_(std::move(stream))
+	{
+		reader_ = std::jthread([this] { read_replies(); });
+	}
+
+	client::~client()
+	{
+		// The reader sees the end of the stream, fails the calls in flight and returns
+		stream_->close();
+	}
+
+	std::future<std::string> client::call(std::string_view request)
+	{
+		auto promise = std::make_shared<std::promise<std::string>>();
+		auto future = promise->get_future();
+
+		call(request, [promise](std::string reply, std::exception_ptr error) {
+			if (error)
+				promise->set_exception(error);
+			else
+				promise->set_value(std::move(reply));
+		});
+
+		return future;
+	}
+
+	void client::call(std::string_view request, completion on_reply)
+	{
+		if (request.size() > MAX_FRAME_SIZE)
+			throw std::length_error{ "request is too large" };
+
+		std::uint64_t id = 0;
+		{
+			std::scoped_lock lock(pending_mutex_);
+			if (closed_)
+				throw std::runtime_error{ "connection is closed" };
+
+			id = next_id_++;
+			pending_.emplace(id, std::move(on_reply));
+		}
+
+		try {
+			std::scoped_lock lock(write_mutex_);
+			write_frame(*stream_, { .request_id = id, .size = static_cast<std::uint32_t>(request.size()) }, request);
+		}
+		catch (...) {
+			// Unless the reader already failed the call when the stream broke
+			std::unique_lock lock(pending_mutex_);
+			if (pending_.erase(id) != 0)
+				throw;
+		}
+	}
+
+	size_t client::in_flight() const
+	{
+		std::scoped_lock lock(pending_mutex_);
+		return pending_.size();
+	}
+
+	void client::read_replies()
+	{
+		try {
+			frame_header header;
+			std::string payload;
+
+			while (read_frame(*stream_, header, payload))
+			{
+				completion on_reply;
+				{
+					std::scoped_lock lock(pending_mutex_);
+					auto it = pending_.find(header.request_id);
+					if (it == pending_.end())
+						continue;
+
+					on_reply = std::move(it->second);
+					pending_.erase(it);
+				}
+
+				if (header.status == 0)
+					on_reply(std::move(payload), nullptr);
+				else
+					on_reply({}, std::make_exception_ptr(std::runtime_error{ payload }));
+
+				payload = {};
+			}
+
+			fail_pending(std::make_exception_ptr(std::runtime_error{ "connection closed" }));
+		}
+		catch (...) {
+			fail_pending(std::current_exception());
+		}
+	}
+
+	void client::fail_pending(std::exception_ptr error)
+	{
+		std::unordered_map<std::uint64_t, completion> failed;
+		{
+			std::scoped_lock lock(pending_mutex_);
+			closed_ = true;
+			failed.swap(pending_);
+		}
+
+		for (auto& [id, on_reply] : failed)
+			on_reply({}, error);
+	}
+
+	struct server::session : std::enable_shared_from_this<session> {
+		std::unique_ptr<duplex_stream> stream;
+		std::mutex write_mutex;
+		std::atomic<bool> done{ false };
+		std::jthread reader;
+	};
+
+	server::server(size_t threads, handler handler)
+		: handler_(std::move(handler))
+	{
+		for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i)
+			workers_.emplace_back([this](std::stop_token stop) { work(stop); });
+	}
+
+	server::~server()
+	{
+		std::vector<std::shared_ptr<session>> sessions;
+		{
+			std::scoped_lock lock(sessions_mutex_);
+			sessions.swap(sessions_);
+		}
+
+		for (auto& s : sessions)
+			s->stream->close();
+
+		for (auto& s : sessions)
+		{
+			if (s->reader.joinable())
+				s->reader.join();
+		}
+
+		for (auto& worker : workers_)
+			worker.request_stop();
+		queued_.notify_all();
+		workers_.clear();
+	}
+
+	void server::serve(std::unique_ptr<duplex_stream> stream)
+	{
+		auto s = std::make_shared<session>();
+		s->stream = std::move(stream);
+
+		std::scoped_lock lock(sessions_mutex_);
+
+		// Sessions whose client went away are dropped here, a reader cannot join itself
+		std::erase_if(sessions_, [](const std::shared_ptr<session>& other) {
+			if (!other->done.load())
+				return false;
+
+			other->reader.join();
+			return true;
+		});
+
+		s->reader = std::jthread([this, origin = s.get()] { read_requests(*origin); });
+		sessions_.push_back(std::move(s));
+	}
+
+	void server::read_requests(session& origin)
+	{
+		const auto self = origin.shared_from_this();
+
+		try {
+			frame_header header;
+			std::string payload;
+
+			while (read_frame(*origin.stream, header, payload))
+			{
+				{
+					std::scoped_lock lock(queue_mutex_);
+					queue_.push_back({ self, header.request_id, std::move(payload) });
+				}
+				queued_.notify_one();
+
+				payload = {};
+			}
+		}
+		catch (const std::exception&) {
+			// A malformed frame ends the session, the client sees the stream close
+		}
+
+		origin.stream->close();
+		origin.done = true;
+	}
+
+	void server::work(std::stop_token stop)
+	{
+		while (true)
+		{
+			job next;
+			{
+				std::unique_lock lock(queue_mutex_);
+				if (!queued_.wait(lock, stop, [&] { return !queue_.empty(); }))
+					return;
+
+				next = std::move(queue_.front());
+				queue_.pop_front();
+			}
+
+			frame_header header{ .request_id = next.request_id };
+			std::string reply;
+			try {
+				reply = handler_(next.request);
+			}
+			catch (const std::exception& e) {
+				reply = e.what();
+				header.status = 1;
+			}
+
+			if (reply.size() > MAX_FRAME_SIZE) {
+				reply = "reply is too large";
+				header.status = 1;
+			}
+
+			header.size = static_cast<std::uint32_t>(reply.size());
+
+			try {
+				std::scoped_lock lock(next.origin->write_mutex);
+				write_frame(*next.origin->stream, header, reply);
+			}
+			catch (const std::exception&) {
+				// The client is gone, nobody waits for the reply
+			}
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Request multiplexing over byte streams: every request carries an id, a client writes requests
+/// back to back without waiting for replies, and the server writes each reply as soon as it is
+/// ready, in any order. A handful of streams then carries any number of concurrent calls.
+namespace load::mux
+{
+	/// Ordered, reliable byte stream in both directions, what a socket or a pipe provides
+	class duplex_stream {
+	public:
+		virtual ~duplex_stream() = default;
+
+		/// Writes all of `data`, throws once the stream is closed
+		virtual void write(std::span<const std::byte> data) = 0;
+
+		/// Waits for data, returns 0 once the stream is closed
+		virtual size_t read(std::span<std::byte> buffer) = 0;
+
+		/// Ends both directions for both ends, blocked reads return 0
+		virtual void close() noexcept = 0;
+	};
+
+	/// Two connected in-memory ends, portable stand-in for a socket pair
+	[[nodiscard]] std::pair<std::unique_ptr<duplex_stream>, std::unique_ptr<duplex_stream>> make_memory_pipe();
+
+	/// Precedes every payload on the wire. A reply with a nonzero status carries an error message.
+	struct frame_header {
+		std::uint64_t request_id = 0;
+		std::uint32_t size = 0;
+		std::uint32_t status = 0;
+	};
+
+	constexpr std::uint32_t MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+	/// Many calls in flight on one stream, replies are matched to calls by request id
+	class client {
+	public:
+		/// Runs on the reply reader thread, with either the reply or the error
+		using completion = std::function<void(std::string reply, std::exception_ptr error)>;
+
+		explicit client(std::unique_ptr<duplex_stream> stream);
+
+		/// Calls still in flight fail with an error
+		~client();
+
+		client(const client&) = delete;
+		client& operator=(const client&) = delete;
+
+		[[nodiscard]] std::future<std::string> call(std::string_view request);
+		void call(std::string_view request, completion on_reply);
+
+		[[nodiscard]] size_t in_flight() const;
+
+	private:
+		void read_replies();
+		void fail_pending(std::exception_ptr error);
+
+		std::unique_ptr<duplex_stream> stream_;
+		std::mutex write_mutex_;
+
+		mutable std::mutex pending_mutex_;
+		std::unordered_map<std::uint64_t, completion> pending_;
+		std::uint64_t next_id_ = 1;
+		bool closed_ = false;
+
+		std::jthread reader_;
+	};
+
+	/// Reads requests from any number of streams and runs `handler` on a pool of `threads`, the
+	/// same queueing structure as the local transport. Replies go out in completion order.
+	class server {
+	public:
+		using handler = std::function<std::string(std::string_view request)>;
+
+		server(size_t threads, handler handler);
+		~server();
+
+		server(const server&) = delete;
+		server& operator=(const server&) = delete;
+
+		/// Serves requests arriving on `stream` until it is closed
+		void serve(std::unique_ptr<duplex_stream> stream);
+
+	private:
+		struct session;
+
+		struct job {
+			std::shared_ptr<session> origin;
+			std::uint64_t request_id = 0;
+			std::string request;
+		};
+
+		void read_requests(session& origin);
+		void work(std::stop_token stop);
+
+		handler handler_;
+
+		std::mutex queue_mutex_;
+		std::condition_variable_any queued_;
+		std::deque<job> queue_;
+		std::vector<std::jthread> workers_;
+
+		std::mutex sessions_mutex_;
+		std::vector<std::shared_ptr<session>> sessions_;
+	};
+}
@@ -0,0 +1,65 @@
+#include "transport.h"
+
+#include "mux.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	class mux_connection final : public load::connection {
+	public:
+		explicit mux_connection(load::mux::client& client)
+			: client_(client)
+		{
+		}
+
+		void pass_and_get_string(const std::string& str) override
+		{
+			std::ignore = client_.call(str).get();
+		}
+
+	private:
+		load::mux::client& client_;
+	};
+
+	class mux_transport final : public load::transport {
+	public:
+		mux_transport(size_t server_threads, size_t streams, load::service_time service)
+			: server_(server_threads, [service](std::string_view request) {
+				// Stands in for the stub callback, as in the local transport
+				thread_local std::mt19937_64 rng{ std::random_device{}() };
+				load::spin_for(service.sample(rng));
+				return std::string(request);
+			})
+		{
+			for (size_t i = 0; i < std::max<size_t>(streams, 1); ++i)
+			{
+				auto [client_end, server_end] = load::mux::make_memory_pipe();
+				server_.serve(std::move(server_end));
+				clients_.push_back(std::make_unique<load::mux::client>(std::move(client_end)));
+			}
+		}
+
+		std::unique_ptr<load::connection> connect() override
+		{
+			return std::make_unique<mux_connection>(*clients_[next_.fetch_add(1) % clients_.size()]);
+		}
+
+	private:
+		load::mux::server server_;
+		std::vector<std::unique_ptr<load::mux::client>> clients_;
+		std::atomic<size_t> next_{ 0 };
+	};
+}
+
+namespace load
+{
+	std::unique_ptr<transport> make_mux_transport(size_t server_threads, size_t streams, service_time service)
+	{
+		return std::make_unique<mux_transport>(server_threads, streams, service);
+	}
+}
@@ -0,0 +1,87 @@
+#include "transport.h"
+
+#ifdef _WIN32
+
+#include "../PlaygroundRpcLib/playground_client.h"
+#include "../PlaygroundRpcLib/playground_server.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <Windows.h>
+
+namespace
+{
+	/// The server callbacks are plain function pointers, so the distribution lives here
+	load::service_time rpc_service;
+
+	char* stub_pass_and_get_string(const char* str)
+	{
+		thread_local std::mt19937_64 rng{ std::random_device{}() };
+		load::spin_for(rpc_service.sample(rng));
+
+		const size_t size = std::strlen(str) + 1;
+		auto* reply = static_cast<char*>(CoTaskMemAlloc(size));
+		if (reply != nullptr)
+			std::memcpy(reply, str, size);
+
+		return reply;
+	}
+
+	class rpc_connection final : public load::connection {
+	public:
+		rpc_connection()
+			: handle_(playground::client::connect())
+		{
+		}
+
+		~rpc_connection() override
+		{
+			playground::client::free_binding(handle_);
+		}
+
+		void pass_and_get_string(const std::string& str) override
+		{
+			std::ignore = playground::client::pass_and_get_string(handle_, str);
+		}
+
+	private:
+		handle_t handle_ = nullptr;
+	};
+
+	class rpc_transport final : public load::transport {
+	public:
+		explicit rpc_transport(load::service_time service)
+		{
+			rpc_service = service;
+			playground::server::initialize({ .pass_and_get_string = &stub_pass_and_get_string });
+
+			// The server shares the process, but the load is meant for the transport
+			playground::client::set_force_rpc(true);
+		}
+
+		~rpc_transport() override
+		{
+			try {
+				playground::server::terminate();
+			}
+			catch (const std::exception&) {
+			}
+		}
+
+		std::unique_ptr<load::connection> connect() override
+		{
+			return std::make_unique<rpc_connection>();
+		}
+	};
+}
+
+namespace load
+{
+	std::unique_ptr<transport> make_rpc_transport(service_time service)
+	{
+		return std::make_unique<rpc_transport>(service);
+	}
+}
+
+#endif
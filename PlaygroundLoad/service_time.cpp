@@ -0,0 +1,131 @@
+#include "service_time.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <vector>
+
+namespace
+{
+	[[nodiscard]] std::vector<std::string_view> split(std::string_view text, char separator)
+	{
+		std::vector<std::string_view> parts;
+		for (size_t start = 0;;)
+		{
+			const auto end = text.find(separator, start);
+			parts.push_back(text.substr(start, end - start));
+			if (end == std::string_view::npos)
+				return parts;
+			start = end + 1;
+		}
+	}
+
+	[[nodiscard]] std::optional<double> to_double(std::string_view text)
+	{
+		double value = 0.0;
+		const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+		if (ec != std::errc{} || ptr != text.data() + text.size() || value < 0.0)
+			return std::nullopt;
+		return value;
+	}
+}
+
+namespace load
+{
+	std::optional<service_time> service_time::parse(std::string_view spec)
+	{
+		const auto parts = split(spec, ':');
+
+		std::vector<double> values;
+		for (size_t i = 1; i < parts.size(); ++i)
+		{
+			const auto value = to_double(parts[i]);
+			if (!value)
+				return std::nullopt;
+			values.push_back(*value);
+		}
+
+		const auto make = [&](kind type, size_t arity) -> std::optional<service_time> {
+			if (values.size() != arity)
+				return std::nullopt;
+
+			values.resize(3);
+			return service_time{ type, values[0], values[1], values[2] };
+		};
+
+		if (parts[0] == "none")
+			return make(kind::none, 0);
+		if (parts[0] == "const")
+			return make(kind::constant, 1);
+		if (parts[0] == "uniform")
+			return make(kind::uniform, 2);
+		if (parts[0] == "exp")
+			return make(kind::exponential, 1);
+		if (parts[0] == "lognormal")
+			return make(kind::lognormal, 2);
+		if (parts[0] == "bimodal")
+			return make(kind::bimodal, 3);
+
+		return std::nullopt;
+	}
+
+	std::chrono::nanoseconds service_time::sample(std::mt19937_64& rng) const
+	{
+		double us = 0.0;
+
+		switch (type)
+		{
+		case kind::none:
+			break;
+		case kind::constant:
+			us = a;
+			break;
+		case kind::uniform:
+			us = std::uniform_real_distribution<double>(std::min(a, b), std::max(a, b))(rng);
+			break;
+		case kind::exponential:
+			us = a > 0.0 ? std::exponential_distribution<double>(1.0 / a)(rng) : 0.0;
+			break;
+		case kind::lognormal:
+			us = a > 0.0 ? std::lognormal_distribution<double>(std::log(a), b)(rng) : 0.0;
+			break;
+		case kind::bimodal:
+			us = std::bernoulli_distribution(std::clamp(p, 0.0, 1.0))(rng) ? b : a;
+			break;
+		}
+
+		return std::chrono::nanoseconds{ static_cast<std::int64_t>(us * 1000.0) };
+	}
+
+	std::string service_time::describe() const
+	{
+		switch (type)
+		{
+		case kind::none:
+			return "none";
+		case kind::constant:
+			return std::format("constant {} us", a);
+		case kind::uniform:
+			return std::format("uniform {}-{} us", a, b);
+		case kind::exponential:
+			return std::format("exponential, mean {} us", a);
+		case kind::lognormal:
+			return std::format("lognormal, median {} us, sigma {}", a, b);
+		case kind::bimodal:
+			return std::format("bimodal {} us / {} us with p(slow) = {}", a, b, p);
+		}
+
+		return {};
+	}
+
+	void spin_for(std::chrono::nanoseconds duration) noexcept
+	{
+		if (duration <= std::chrono::nanoseconds::zero())
+			return;
+
+		const auto until = std::chrono::steady_clock::now() + duration;
+		while (std::chrono::steady_clock::now() < until) {
+		}
+	}
+}
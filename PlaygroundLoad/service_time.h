@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace load
+{
+	/// Distribution of the time a stub callback takes, all parameters in microseconds
+	struct service_time {
+		enum class kind {
+			none,
+			constant,      // const:<us>
+			uniform,       // uniform:<min us>:<max us>
+			exponential,   // exp:<mean us>
+			lognormal,     // lognormal:<median us>:<sigma>
+			bimodal,       // bimodal:<fast us>:<slow us>:<probability of slow>
+		};
+
+		kind type = kind::none;
+		double a = 0.0;
+		double b = 0.0;
+		double p = 0.0;
+
+		[[nodiscard]] static std::optional<service_time> parse(std::string_view spec);
+
+		[[nodiscard]] std::chrono::nanoseconds sample(std::mt19937_64& rng) const;
+
+		[[nodiscard]] std::string describe() const;
+	};
+
+	/// Busy-waits, so the service time models CPU work and is not rounded up to the timer resolution
+	void spin_for(std::chrono::nanoseconds duration) noexcept;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "service_time.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace load
+{
+	/// One client connection, calls on it do not overlap, like calls on an RPC binding handle
+	class connection {
+	public:
+		virtual ~connection() = default;
+
+		/// Throws on failure
+		virtual void pass_and_get_string(const std::string& str) = 0;
+	};
+
+	/// Server with stub callbacks taking `service_time`, plus the means to connect to it
+	class transport {
+	public:
+		virtual ~transport() = default;
+
+		[[nodiscard]] virtual std::unique_ptr<connection> connect() = 0;
+	};
+
+	/// In-process server with a bounded pool of `server_threads` serving a shared queue, the same
+	/// queueing structure as the RPC runtime's call dispatch. Portable, runs anywhere.
+	[[nodiscard]] std::unique_ptr<transport> make_local_transport(size_t server_threads, service_time service);
+
+	/// The same server pool behind `streams` multiplexed in-memory byte streams, see `mux.h`.
+	/// Connections are logical: they share the streams round-robin, requests carry ids and replies
+	/// come back in completion order, so any number of connections costs `streams` of them.
+	[[nodiscard]] std::unique_ptr<transport> make_mux_transport(size_t server_threads, size_t streams, service_time service);
+
+#ifdef _WIN32
+	/// The real thing: `playground::server` in this process, reached over ncalrpc
+	[[nodiscard]] std::unique_ptr<transport> make_rpc_transport(service_time service);
+#endif
+}
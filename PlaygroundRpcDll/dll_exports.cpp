@@ -1,30 +1,90 @@
 ﻿#include "../PlaygroundRpcLib/playground_client.h"
 #include "../PlaygroundRpcLib/playground_server.h"
+#include "../PlaygroundRpcLib/alloc_profiler.h"
+#include "../PlaygroundRpcLib/batch_reader.h"
+#include "../PlaygroundRpcLib/call_metrics.h"
+#include "../PlaygroundRpcLib/call_trace.h"
 #include "../PlaygroundRpcLib/callbacks.h"
+#include "../PlaygroundRpcLib/crc32c.h"
+#include "../PlaygroundRpcLib/error_log.h"
+#include "../PlaygroundRpcLib/file_cache.h"
+#include "../PlaygroundRpcLib/flight_recorder.h"
+#include "../PlaygroundRpcLib/hedging.h"
+#include "../PlaygroundRpcLib/mapped_file.h"
 #include "../Common/defer.h"
 
 #include <Windows.h>
 
-#include <array>
-#include <print>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
 
-[[nodiscard]] static char* alloc_co_task_string(std::string_view str)
+/// Returns null when out of memory, for the exports which return a status instead of throwing
+[[nodiscard]] static char* try_alloc_co_task_string(std::string_view str) noexcept
 {
 	const size_t buffer_size = str.size() + 1;
 
 	auto* buffer = static_cast<char*>(CoTaskMemAlloc(buffer_size));
+	if (buffer == nullptr)
+		return nullptr;
+
+	// The view is not necessarily zero-terminated, e.g. a mapped file ending on a page boundary
+	std::memcpy(buffer, str.data(), str.size());
+	buffer[str.size()] = '\0';
+
+	playground::alloc_profiler::record_handover(playground::alloc_profiler::site::co_task_string, buffer_size);
+	return buffer;
+}
+
+[[nodiscard]] static char* alloc_co_task_string(std::string_view str)
+{
+	auto* buffer = try_alloc_co_task_string(str);
 	if (buffer == nullptr)
 		throw std::bad_alloc{};
 
-	if (auto err = memcpy_s(buffer, buffer_size, str.data(), buffer_size); err != 0)
+	return buffer;
+}
+
+/// Logs through the rate limit and returns the status, for the exports which never throw
+static std::uint32_t report_failure(const playground::rpc_error& error) noexcept
+{
+	playground::error_log::report(error);
+	return error.status;
+}
+
+[[nodiscard]] static std::uint8_t* alloc_co_task_bytes(std::span<const std::byte> data)
+{
+	// CoTaskMemAlloc(0) may return a valid pointer, but a null buffer with zero size is easier to marshal
+	if (data.empty())
+		return nullptr;
+
+	auto* buffer = static_cast<std::uint8_t*>(CoTaskMemAlloc(data.size()));
+	if (buffer == nullptr)
+		throw std::bad_alloc{};
+
+	if (auto err = memcpy_s(buffer, data.size(), data.data(), data.size()); err != 0)
 	{
 		CoTaskMemFree(buffer);
 		throw std::exception{ "memcpy_s failed" };
 	}
 
+	playground::alloc_profiler::record_handover(playground::alloc_profiler::site::co_task_bytes, data.size());
 	return buffer;
 }
 
+static playground::file_cache& get_file_cache()
+{
+	static playground::file_cache cache(playground::DEFAULT_FILE_CACHE_BUDGET);
+	return cache;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Server exports
 
@@ -35,7 +95,20 @@ extern "C" __declspec(dllexport) bool server_initialize(playground::callbacks ca
 		return true;
 	}
 	catch (const std::exception& e) {
-		std::println("Error: {}", e.what());
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
+
+/// Also listens on `shards` endpoints, which a `shard_pool_create` pool spreads calls over
+extern "C" __declspec(dllexport) bool server_initialize_sharded(playground::callbacks callbacks, std::uint32_t shards)
+{
+	try {
+		playground::server::initialize(callbacks, shards);
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
 		return false;
 	}
 }
@@ -47,48 +120,221 @@ extern "C" __declspec(dllexport) bool server_terminate()
 		return true;
 	}
 	catch (const std::exception& e) {
-		std::println("Error: {}", e.what());
+		playground::error_log::report(e.what());
 		return false;
 	}
 }
 
+extern "C" __declspec(dllexport) bool server_set_content_store_budget(std::size_t budget_bytes)
+{
+	try {
+		playground::server::set_content_store_budget(budget_bytes);
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
+
+/// Tunes the grouping of concurrent requests for `callbacks::pass_and_get_string_batch`
+extern "C" __declspec(dllexport) bool server_set_batch_options(std::uint32_t window_us, std::size_t max_batch_size)
+{
+	if (max_batch_size == 0)
+		return false;
+
+	playground::server::set_batch_options({ .window = std::chrono::microseconds(window_us), .max_batch_size = max_batch_size });
+	return true;
+}
+
+extern "C" __declspec(dllexport) bool server_get_batch_stats(playground::batch_stats* stats)
+{
+	if (stats == nullptr)
+		return false;
+
+	*stats = playground::server::get_batch_stats();
+	return true;
+}
+
+/// For callbacks polling while they work: the call they serve passed its deadline or was cancelled
+extern "C" __declspec(dllexport) bool server_is_call_cancelled()
+{
+	return playground::server::is_call_cancelled();
+}
+
+/// Routes `invoke` calls with `method_id` to `handler`, replacing any previous one
+extern "C" __declspec(dllexport) bool server_register_method(std::uint32_t method_id, playground::method_handler_t handler, void* context)
+{
+	return playground::server::register_method(method_id, handler, context);
+}
+
+/// Returns once no call runs the handler any more, so it may be released right after
+extern "C" __declspec(dllexport) bool server_unregister_method(std::uint32_t method_id)
+{
+	return playground::server::unregister_method(method_id);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Client exports (testing only)
 
+/// Keeps calls on NDR and the transport even while this process serves the endpoint
+extern "C" __declspec(dllexport) void client_force_rpc(bool force)
+{
+	playground::client::set_force_rpc(force);
+}
+
+extern "C" __declspec(dllexport) std::uint64_t client_get_in_process_calls()
+{
+	return playground::client::get_in_process_calls();
+}
+
 extern "C" __declspec(dllexport) char* get_file_content(const char* filepath, bool show_message_box)
 {
 	try {
-		auto handle = CreateFileA(
-			filepath,
-			GENERIC_READ,
-			FILE_SHARE_READ,
-			nullptr,
-			OPEN_EXISTING,
-			FILE_ATTRIBUTE_NORMAL,
-			nullptr);
+		// Copied exactly once, from the mapped view into the caller-owned buffer
+		const auto file = playground::mapped_file::open(filepath);
+		auto* content = alloc_co_task_string(file.view());
 
-		if (handle == INVALID_HANDLE_VALUE)
-			throw std::system_error(GetLastError(), std::system_category(), "CreateFileA failed");
+		if (show_message_box)
+			MessageBoxA(nullptr, content, "A message from PlaygroundRpc", MB_OK);
 
-		defer(std::ignore = CloseHandle(handle));
+		return content;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
 
-		constexpr size_t buffer_size = 512;
-		std::array<char, buffer_size> buffer{};
+/// Same as `get_file_content` without the message box, also returning the CRC-32C of the content when
+/// `checksum` is not null. The checksum is computed while copying, not as a second pass.
+extern "C" __declspec(dllexport) char* get_file_content_checksum(const char* filepath, std::uint32_t* checksum)
+{
+	try {
+		const auto file = playground::mapped_file::open(filepath);
+		if (checksum == nullptr)
+			return alloc_co_task_string(file.view());
 
-		if (!ReadFile(handle, buffer.data(), buffer_size - 1, nullptr, nullptr))
-			throw std::system_error(GetLastError(), std::system_category(), "ReadFile failed");
+		auto* content = static_cast<char*>(CoTaskMemAlloc(file.size() + 1));
+		if (content == nullptr)
+			throw std::bad_alloc{};
 
-		if (show_message_box)
-			MessageBoxA(nullptr, buffer.data(), "A message from PlaygroundRpc", MB_OK);
+		*checksum = playground::copy_crc32c(content, file.data(), file.size());
+		content[file.size()] = '\0';
+
+		playground::alloc_profiler::record_handover(playground::alloc_profiler::site::co_task_string, file.size() + 1);
+
+		return content;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// CRC-32C of the file content, read through the mapping without copying it
+extern "C" __declspec(dllexport) bool get_file_checksum(const char* filepath, std::uint32_t* checksum)
+{
+	try {
+		if (checksum == nullptr)
+			throw std::invalid_argument{ "checksum cannot be null" };
+
+		const auto file = playground::mapped_file::open(filepath);
+		*checksum = playground::crc32c(file.view());
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
 
-		return alloc_co_task_string(buffer.data());
+/// Same as `get_file_content` without the message box, but served from the in-process file cache
+/// while the file keeps its size and last write time
+extern "C" __declspec(dllexport) char* get_file_content_cached(const char* filepath)
+{
+	try {
+		const auto content = get_file_cache().get(filepath);
+		return alloc_co_task_string(*content);
 	}
 	catch (const std::exception& e) {
-		std::println("Error: {}", e.what());
+		playground::error_log::report(e.what());
 		return nullptr;
 	}
 }
 
+extern "C" __declspec(dllexport) bool set_file_cache_budget(std::size_t budget_bytes)
+{
+	get_file_cache().set_budget(budget_bytes);
+	return true;
+}
+
+extern "C" __declspec(dllexport) bool get_file_cache_stats(playground::file_cache_stats* stats)
+{
+	if (stats == nullptr)
+		return false;
+
+	*stats = get_file_cache().stats();
+	return true;
+}
+
+/// Reads `count` files concurrently into a single `CoTaskMemAlloc` buffer, laid out as described in
+/// `batch_reader.h`, with per-file status. Returns null only when the batch as a whole fails.
+extern "C" __declspec(dllexport) std::uint8_t* read_files(const char* const* filepaths, std::size_t count, std::size_t queue_depth)
+{
+	try {
+		if (filepaths == nullptr && count != 0)
+			throw std::invalid_argument{ "filepaths cannot be null" };
+
+		auto* buffer = playground::read_files_packed(
+			std::span{ filepaths, count },
+			queue_depth,
+			[](size_t size) {
+				auto* buffer = static_cast<std::byte*>(CoTaskMemAlloc(size));
+				if (buffer == nullptr)
+					throw std::bad_alloc{};
+
+				return buffer;
+			},
+			[](std::byte* buffer) { CoTaskMemFree(buffer); });
+
+		const auto* header = reinterpret_cast<const playground::packed_files_header*>(buffer);
+		playground::alloc_profiler::record_handover(playground::alloc_profiler::site::co_task_bytes, header->total_size);
+
+		return reinterpret_cast<std::uint8_t*>(buffer);
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// Maps the whole file read-only without copying it. The view is not zero-terminated and
+/// stays valid until `unmap_file_content` is called with `*mapping`.
+extern "C" __declspec(dllexport) bool map_file_content(const char* filepath, const char** data, std::size_t* size, playground::mapped_file** mapping)
+{
+	try {
+		if (data == nullptr || size == nullptr || mapping == nullptr)
+			throw std::invalid_argument{ "data, size and mapping cannot be null" };
+
+		auto file = std::make_unique<playground::mapped_file>(playground::mapped_file::open(filepath));
+
+		*data = file->data();
+		*size = file->size();
+		*mapping = file.release();
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
+
+extern "C" __declspec(dllexport) void unmap_file_content(playground::mapped_file* mapping)
+{
+	delete mapping;
+}
+
 extern "C" __declspec(dllexport) void pass_and_get_string_out(const char* str, char** out_str)
 {
 	try {
@@ -96,14 +342,14 @@ extern "C" __declspec(dllexport) void pass_and_get_string_out(const char* str, c
 			throw std::invalid_argument{ "out_str cannot be null" };
 
 		auto handle = playground::client::connect();
-		defer(std::ignore = RpcBindingFree(&handle));
+		defer(playground::client::free_binding(handle));
 
 		auto result_str = playground::client::pass_and_get_string(handle, str);
 
 		*out_str = alloc_co_task_string(result_str);
 	}
 	catch (const std::exception& e) {
-		std::println("Error: {}", e.what());
+		playground::error_log::report(e.what());
 	}
 }
 
@@ -111,14 +357,545 @@ extern "C" __declspec(dllexport) char* pass_and_get_string(const char* str)
 {
 	try {
 		auto handle = playground::client::connect();
-		defer(std::ignore = RpcBindingFree(&handle));
+		defer(playground::client::free_binding(handle));
 
 		auto result_str = playground::client::pass_and_get_string(handle, str);
 
 		return alloc_co_task_string(result_str);
 	}
 	catch (const std::exception& e) {
-		std::println("Error: {}", e.what());
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// Writes the reply, zero-terminated, into the caller's `buffer` of `capacity` bytes instead of a
+/// `CoTaskMemAlloc` string, so hot loops can reuse one pinned buffer. `*length` receives the reply
+/// length without the terminator. Returns ERROR_INSUFFICIENT_BUFFER when the reply does not fit;
+/// nothing is written then, and the call has to be repeated with at least `*length + 1` bytes.
+/// Other failures return their system error code.
+extern "C" __declspec(dllexport) std::uint32_t pass_and_get_string_into(const char* str, char* buffer, std::size_t capacity, std::size_t* length)
+{
+	if (length == nullptr || (buffer == nullptr && capacity != 0))
+		return report_failure({ ERROR_INVALID_PARAMETER, "pass_and_get_string_into" });
+
+	auto handle = playground::client::try_connect();
+	if (!handle)
+		return report_failure(handle.error());
+
+	defer(playground::client::free_binding(*handle));
+
+	auto result = playground::client::try_pass_and_get_string_into(*handle, str, std::span{ buffer, capacity });
+	if (!result)
+		return report_failure(result.error());
+
+	*length = *result;
+	return *length < capacity ? ERROR_SUCCESS : ERROR_INSUFFICIENT_BUFFER;
+}
+
+/// `call` makes the call on a binding to `endpoint` it is given
+template <class Call> requires std::is_nothrow_invocable_r_v<playground::rpc_result<std::string>, Call&, handle_t>
+static std::uint32_t pass_and_get_string_status(Call&& call, char** out_str, const char* operation, const char* endpoint = playground::ENDPOINT) noexcept
+{
+	if (out_str == nullptr || endpoint == nullptr)
+		return report_failure({ ERROR_INVALID_PARAMETER, operation });
+
+	*out_str = nullptr;
+
+	auto handle = playground::client::try_connect(endpoint);
+	if (!handle)
+		return report_failure(handle.error());
+
+	defer(playground::client::free_binding(*handle));
+
+	auto result = call(*handle);
+	if (!result)
+		return report_failure(result.error());
+
+	*out_str = try_alloc_co_task_string(*result);
+	if (*out_str == nullptr)
+		return report_failure({ ERROR_NOT_ENOUGH_MEMORY, operation });
+
+	return ERROR_SUCCESS;
+}
+
+/// Status-returning variant of `pass_and_get_string`, which does not throw internally on failure.
+/// `*out_str` receives a `CoTaskMemAlloc` string on success and null otherwise.
+extern "C" __declspec(dllexport) std::uint32_t pass_and_get_string_ex(const char* str, char** out_str)
+{
+	return pass_and_get_string_status(
+		[&](handle_t handle) noexcept { return playground::client::try_pass_and_get_string(handle, str); },
+		out_str,
+		"pass_and_get_string_ex");
+}
+
+/// As `pass_and_get_string_ex`, failing with ERROR_TIMEOUT when no reply came within `timeout_ms`
+extern "C" __declspec(dllexport) std::uint32_t pass_and_get_string_timeout(const char* str, std::uint32_t timeout_ms, char** out_str)
+{
+	const auto until = playground::deadline::clock::now() + std::chrono::milliseconds(timeout_ms);
+	return pass_and_get_string_status(
+		[&](handle_t handle) noexcept { return playground::client::try_pass_and_get_string(handle, str, until); },
+		out_str,
+		"pass_and_get_string_timeout");
+}
+
+/// As `pass_and_get_string_ex`, making up to `max_attempts` attempts while failures are transient
+/// and the process-wide retry budget allows
+extern "C" __declspec(dllexport) std::uint32_t pass_and_get_string_retry(const char* str, std::uint32_t max_attempts, char** out_str)
+{
+	const playground::client::retry_policy policy{ .max_attempts = max_attempts };
+	return pass_and_get_string_status(
+		[&](handle_t handle) noexcept { return playground::client::try_pass_and_get_string(handle, str, policy); },
+		out_str,
+		"pass_and_get_string_retry");
+}
+
+/// As `pass_and_get_string_retry`, on a binding to `endpoint`
+extern "C" __declspec(dllexport) std::uint32_t pass_and_get_string_retry_at(const char* endpoint, const char* str, std::uint32_t max_attempts, char** out_str)
+{
+	const playground::client::retry_policy policy{ .max_attempts = max_attempts };
+	return pass_and_get_string_status(
+		[&](handle_t handle) noexcept { return playground::client::try_pass_and_get_string(handle, str, policy); },
+		out_str,
+		"pass_and_get_string_retry_at",
+		endpoint);
+}
+
+/// `data` may contain zeros, the result is a `CoTaskMemAlloc` buffer of `*out_size` bytes
+extern "C" __declspec(dllexport) std::uint8_t* pass_and_get_bytes(const std::uint8_t* data, std::size_t size, std::size_t* out_size)
+{
+	try {
+		if (out_size == nullptr)
+			throw std::invalid_argument{ "out_size cannot be null" };
+
+		*out_size = 0;
+
+		auto handle = playground::client::connect();
+		defer(playground::client::free_binding(handle));
+
+		auto result = playground::client::pass_and_get_bytes(handle, std::as_bytes(std::span{ data, size }));
+
+		auto* buffer = alloc_co_task_bytes(result);
+		*out_size = result.size();
+		return buffer;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// Calls the server handler registered under `method_id`. `*out_data` is a `CoTaskMemAlloc` buffer
+/// of `*out_size` bytes, null for an empty reply. Returns false when the call or the handler fails.
+extern "C" __declspec(dllexport) bool invoke_method(std::uint32_t method_id, const std::uint8_t* data, std::size_t size, std::uint8_t** out_data, std::size_t* out_size)
+{
+	try {
+		if (out_data == nullptr || out_size == nullptr)
+			throw std::invalid_argument{ "out_data and out_size cannot be null" };
+
+		*out_data = nullptr;
+		*out_size = 0;
+
+		auto handle = playground::client::connect();
+		defer(playground::client::free_binding(handle));
+
+		auto result = playground::client::invoke(handle, method_id, std::as_bytes(std::span{ data, size }));
+
+		*out_data = alloc_co_task_bytes(result);
+		*out_size = result.size();
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
+
+/// Sends only the content hash when the server already has the payload stored
+extern "C" __declspec(dllexport) char* pass_and_get_string_dedup(const char* str)
+{
+	try {
+		auto handle = playground::client::connect();
+		defer(playground::client::free_binding(handle));
+
+		auto result_str = playground::client::pass_and_get_string_dedup(handle, str);
+
+		return alloc_co_task_string(result_str);
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+struct dedup_stats {
+	playground::client::dedup_stats client;
+	playground::content_store_stats server;
+};
+
+extern "C" __declspec(dllexport) bool get_dedup_stats(dedup_stats* stats)
+{
+	if (stats == nullptr)
+		return false;
+
+	stats->client = playground::client::get_dedup_stats();
+	stats->server = playground::server::get_content_store_stats();
+	return true;
+}
+
+/// Owns the binding of a delta session, so consecutive calls diff against the same server-side state
+struct delta_session_handle {
+	handle_t binding = nullptr;
+	std::optional<playground::client::delta_session> session;
+
+	~delta_session_handle() { playground::client::free_binding(binding); }
+};
+
+extern "C" __declspec(dllexport) delta_session_handle* delta_session_create()
+{
+	try {
+		auto handle = std::make_unique<delta_session_handle>();
+		handle->binding = playground::client::connect();
+		handle->session.emplace(handle->binding);
+		return handle.release();
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+extern "C" __declspec(dllexport) void delta_session_destroy(delta_session_handle* handle)
+{
+	delete handle;
+}
+
+extern "C" __declspec(dllexport) char* delta_session_pass_and_get_string(delta_session_handle* handle, const char* str)
+{
+	try {
+		if (handle == nullptr)
+			throw std::invalid_argument{ "handle cannot be null" };
+
+		auto result_str = handle->session->pass_and_get_string(str);
+
+		return alloc_co_task_string(result_str);
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
 		return nullptr;
 	}
 }
+
+extern "C" __declspec(dllexport) bool delta_session_get_stats(const delta_session_handle* handle, playground::client::delta_stats* stats)
+{
+	if (handle == nullptr || stats == nullptr)
+		return false;
+
+	*stats = handle->session->stats();
+	return true;
+}
+
+extern "C" __declspec(dllexport) playground::client::shard_pool* shard_pool_create(std::uint32_t shards)
+{
+	try {
+		return new playground::client::shard_pool(shards);
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+extern "C" __declspec(dllexport) void shard_pool_destroy(playground::client::shard_pool* pool)
+{
+	delete pool;
+}
+
+/// Calls with the same `key` go to the same shard
+extern "C" __declspec(dllexport) char* shard_pool_pass_and_get_string_keyed(playground::client::shard_pool* pool, std::uint64_t key, const char* str)
+{
+	try {
+		if (pool == nullptr)
+			throw std::invalid_argument{ "pool cannot be null" };
+
+		return alloc_co_task_string(pool->pass_and_get_string(key, str));
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// Calls the shard with the fewest calls in flight
+extern "C" __declspec(dllexport) char* shard_pool_pass_and_get_string(playground::client::shard_pool* pool, const char* str)
+{
+	try {
+		if (pool == nullptr)
+			throw std::invalid_argument{ "pool cannot be null" };
+
+		return alloc_co_task_string(pool->pass_and_get_string(str));
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// Hedges calls over `count` replica endpoints after `delay_us`, or after the observed p95 latency
+/// when 0, with at most `max_hedge_ratio` duplicates per call
+extern "C" __declspec(dllexport) playground::client::hedged_client* hedged_client_create(
+	const char* const* endpoints,
+	std::uint32_t count,
+	std::uint32_t delay_us,
+	double max_hedge_ratio)
+{
+	try {
+		if (endpoints == nullptr && count != 0)
+			throw std::invalid_argument{ "endpoints cannot be null" };
+
+		const std::vector<std::string> names(endpoints, endpoints + count);
+		return new playground::client::hedged_client(names, {
+			.delay = std::chrono::microseconds(delay_us),
+			.max_hedge_ratio = max_hedge_ratio,
+		});
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+extern "C" __declspec(dllexport) void hedged_client_destroy(playground::client::hedged_client* client)
+{
+	delete client;
+}
+
+extern "C" __declspec(dllexport) char* hedged_client_pass_and_get_string(playground::client::hedged_client* client, const char* str)
+{
+	try {
+		if (client == nullptr)
+			throw std::invalid_argument{ "client cannot be null" };
+
+		return alloc_co_task_string(client->pass_and_get_string(str));
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+extern "C" __declspec(dllexport) bool hedged_client_get_stats(playground::client::hedged_client* client, playground::client::hedge_stats* stats)
+{
+	if (client == nullptr || stats == nullptr)
+		return false;
+
+	*stats = client->stats();
+	return true;
+}
+
+using stream_reply_t = void (*)(const std::uint8_t* data, std::size_t size);
+
+/// Streams the file to the server in chunks of `chunk_size` with `queue_depth` read-ahead buffers,
+/// `on_reply` is optional and receives the reply to each chunk
+extern "C" __declspec(dllexport) bool stream_file_content(
+	const char* filepath,
+	std::size_t chunk_size,
+	std::size_t queue_depth,
+	stream_reply_t on_reply,
+	std::uint64_t* bytes_sent)
+{
+	try {
+		auto handle = playground::client::connect();
+		defer(playground::client::free_binding(handle));
+
+		std::function<void(std::span<const std::byte>)> forward_reply;
+		if (on_reply != nullptr) {
+			forward_reply = [on_reply](std::span<const std::byte> reply) {
+				on_reply(reinterpret_cast<const std::uint8_t*>(reply.data()), reply.size());
+			};
+		}
+
+		const auto stats = playground::client::stream_file(
+			handle,
+			filepath,
+			{ .chunk_size = chunk_size, .queue_depth = queue_depth },
+			forward_reply);
+
+		if (bytes_sent != nullptr)
+			*bytes_sent = stats.bytes;
+
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Diagnostics exports, covering the client and the server in this process
+
+/// Printed errors per second, further ones are only counted. 0 silences the output.
+extern "C" __declspec(dllexport) void set_error_log_rate(std::uint32_t messages_per_second)
+{
+	playground::error_log::set_rate(messages_per_second);
+}
+
+/// Errors which were not printed because of the rate limit
+extern "C" __declspec(dllexport) std::uint64_t get_suppressed_errors()
+{
+	return playground::error_log::suppressed();
+}
+
+/// Share of calls made with a retry policy which may be retried
+extern "C" __declspec(dllexport) void set_retry_budget(double ratio)
+{
+	playground::client::set_retry_budget(ratio);
+}
+
+/// Full budget at the default ratio and zero stats
+extern "C" __declspec(dllexport) void reset_retries()
+{
+	playground::client::reset_retries();
+}
+
+extern "C" __declspec(dllexport) bool get_retry_stats(playground::client::retry_stats* stats)
+{
+	if (stats == nullptr)
+		return false;
+
+	*stats = playground::client::get_retry_stats();
+	return true;
+}
+
+/// Calls which ran out of time, on the client and on the server in this process
+extern "C" __declspec(dllexport) bool get_deadline_stats(playground::deadline::deadline_stats* stats)
+{
+	if (stats == nullptr)
+		return false;
+
+	*stats = playground::deadline::get_stats();
+	return true;
+}
+
+/// Counters and latency percentiles of one method, merged over all threads at the time of the call
+extern "C" __declspec(dllexport) bool get_call_metrics(
+	playground::metrics::side side,
+	playground::metrics::method method,
+	playground::metrics::method_snapshot* snapshot)
+{
+	if (snapshot == nullptr || side >= playground::metrics::side::count || method >= playground::metrics::method::count)
+		return false;
+
+	try {
+		*snapshot = playground::metrics::snapshot(side, method);
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
+
+extern "C" __declspec(dllexport) void reset_call_metrics()
+{
+	playground::metrics::reset();
+}
+
+/// Starts tracing call phases, discarding the previous trace. 0 keeps the default buffer size.
+extern "C" __declspec(dllexport) void trace_start(std::size_t events_per_thread)
+{
+	playground::trace::start(events_per_thread != 0 ? events_per_thread : playground::trace::DEFAULT_EVENTS_PER_THREAD);
+}
+
+extern "C" __declspec(dllexport) void trace_stop()
+{
+	playground::trace::stop();
+}
+
+/// Chrome trace event JSON of the last trace, call after `trace_stop`
+extern "C" __declspec(dllexport) char* get_trace_json()
+{
+	try {
+		return alloc_co_task_string(playground::trace::to_chrome_json());
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// 0 turns allocation sampling off, 1 records every allocation, otherwise about one allocation per
+/// `sample_interval` bytes is sampled
+extern "C" __declspec(dllexport) void set_alloc_sample_interval(std::uint64_t sample_interval)
+{
+	playground::alloc_profiler::set_sample_interval(sample_interval);
+}
+
+extern "C" __declspec(dllexport) bool get_alloc_stats(playground::alloc_profiler::site site, playground::alloc_profiler::site_stats* stats)
+{
+	if (stats == nullptr || site >= playground::alloc_profiler::site::count)
+		return false;
+
+	*stats = playground::alloc_profiler::stats(site);
+	return true;
+}
+
+extern "C" __declspec(dllexport) void reset_alloc_stats()
+{
+	playground::alloc_profiler::reset();
+}
+
+/// Calls at least this slow are also kept in the ring of slow calls
+extern "C" __declspec(dllexport) void flight_recorder_set_slow_threshold(std::uint64_t threshold_ns)
+{
+	playground::flight_recorder::set_slow_threshold(threshold_ns);
+}
+
+/// The last calls and the last slow calls as JSON
+extern "C" __declspec(dllexport) char* flight_recorder_dump()
+{
+	try {
+		return alloc_co_task_string(playground::flight_recorder::to_json());
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return nullptr;
+	}
+}
+
+/// Dumps both rings into `directory` whenever the p99 latency over a window of `window_calls` calls
+/// exceeds `p99_threshold_ns`, at most once per `cooldown_seconds`
+extern "C" __declspec(dllexport) bool flight_recorder_arm(
+	const char* directory,
+	std::uint64_t p99_threshold_ns,
+	std::uint32_t window_calls,
+	std::uint32_t cooldown_seconds)
+{
+	try {
+		if (directory == nullptr)
+			throw std::invalid_argument{ "directory cannot be null" };
+
+		playground::flight_recorder::arm({
+			.directory = directory,
+			.p99_threshold_ns = p99_threshold_ns,
+			.window_calls = window_calls,
+			.cooldown = std::chrono::seconds{ cooldown_seconds },
+		});
+		return true;
+	}
+	catch (const std::exception& e) {
+		playground::error_log::report(e.what());
+		return false;
+	}
+}
+
+extern "C" __declspec(dllexport) void flight_recorder_disarm()
+{
+	playground::flight_recorder::disarm();
+}
+
+extern "C" __declspec(dllexport) std::uint64_t flight_recorder_auto_dumps()
+{
+	return playground::flight_recorder::auto_dumps();
+}
@@ -59,6 +59,18 @@ extern "C"{
 /* interface playground_interface */
 /* [version][uuid] */ 
 
+typedef struct call_context
+    {
+    unsigned hyper call_id;
+    } 	call_context;
+
+typedef struct deadline_context
+    {
+    unsigned hyper call_id;
+    unsigned hyper deadline_ns;
+    } 	deadline_context;
+
+
 /* client prototype */
 error_status_t c_pass_and_get_string( 
     /* [in] */ handle_t binding_handle,
@@ -70,6 +82,106 @@ error_status_t s_pass_and_get_string(
     /* [string][in] */ const char *str,
     /* [string][out] */ char **out_str);
 
+/* client prototype */
+error_status_t c_pass_and_get_bytes( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ unsigned long size,
+    /* [size_is][in] */ const byte *data,
+    /* [out] */ unsigned long *out_size,
+    /* [size_is][size_is][out] */ byte **out_data);
+/* server prototype */
+error_status_t s_pass_and_get_bytes( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ unsigned long size,
+    /* [size_is][in] */ const byte *data,
+    /* [out] */ unsigned long *out_size,
+    /* [size_is][size_is][out] */ byte **out_data);
+
+/* client prototype */
+error_status_t c_pass_hash_and_get_string( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const byte hash[ 32 ],
+    /* [out] */ boolean *found,
+    /* [string][out] */ char **out_str);
+/* server prototype */
+error_status_t s_pass_hash_and_get_string( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const byte hash[ 32 ],
+    /* [out] */ boolean *found,
+    /* [string][out] */ char **out_str);
+
+/* client prototype */
+error_status_t c_pass_hashed_and_get_string( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const byte hash[ 32 ],
+    /* [string][in] */ const char *str,
+    /* [string][out] */ char **out_str);
+/* server prototype */
+error_status_t s_pass_hashed_and_get_string( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const byte hash[ 32 ],
+    /* [string][in] */ const char *str,
+    /* [string][out] */ char **out_str);
+
+/* client prototype */
+error_status_t c_pass_delta_and_get_string( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ unsigned hyper session_id,
+    /* [in] */ unsigned long base_version,
+    /* [in] */ unsigned long size,
+    /* [size_is][in] */ const byte *delta,
+    /* [string][out] */ char **out_str);
+/* server prototype */
+error_status_t s_pass_delta_and_get_string( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ unsigned hyper session_id,
+    /* [in] */ unsigned long base_version,
+    /* [in] */ unsigned long size,
+    /* [size_is][in] */ const byte *delta,
+    /* [string][out] */ char **out_str);
+
+/* client prototype */
+error_status_t c_pass_and_get_string_ctx( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const call_context *context,
+    /* [string][in] */ const char *str,
+    /* [string][out] */ char **out_str);
+/* server prototype */
+error_status_t s_pass_and_get_string_ctx( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const call_context *context,
+    /* [string][in] */ const char *str,
+    /* [string][out] */ char **out_str);
+
+/* client prototype */
+error_status_t c_invoke( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ unsigned long method_id,
+    /* [in] */ unsigned long size,
+    /* [size_is][in] */ const byte *data,
+    /* [out] */ unsigned long *out_size,
+    /* [size_is][size_is][out] */ byte **out_data);
+/* server prototype */
+error_status_t s_invoke( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ unsigned long method_id,
+    /* [in] */ unsigned long size,
+    /* [size_is][in] */ const byte *data,
+    /* [out] */ unsigned long *out_size,
+    /* [size_is][size_is][out] */ byte **out_data);
+
+/* client prototype */
+error_status_t c_pass_and_get_string_deadline( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const deadline_context *context,
+    /* [string][in] */ const char *str,
+    /* [string][out] */ char **out_str);
+/* server prototype */
+error_status_t s_pass_and_get_string_deadline( 
+    /* [in] */ handle_t binding_handle,
+    /* [in] */ const deadline_context *context,
+    /* [string][in] */ const char *str,
+    /* [string][out] */ char **out_str);
 
 
 extern RPC_IF_HANDLE c_playground_interface_v1_0_c_ifspec;
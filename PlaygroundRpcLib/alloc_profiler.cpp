@@ -0,0 +1,252 @@
+#include "alloc_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <tuple>
+
+namespace
+{
+	using playground::alloc_profiler::site;
+
+	constexpr size_t SITES = static_cast<size_t>(site::count);
+
+	/// Keeps the 16 byte alignment of `malloc`
+	struct alignas(16) block_header {
+		/// Estimated bytes this block stands for, 0 when it was not sampled
+		std::uint64_t weighted_bytes = 0;
+		std::uint32_t weighted_count = 0;
+		std::uint16_t site = 0;
+		/// Blocks allocated before the last reset are not subtracted from the live bytes
+		std::uint16_t epoch = 0;
+	};
+
+	static_assert(sizeof(block_header) == 16);
+
+	/// Sampled allocations are rare, shared atomics are cheap enough for them
+	struct site_counters {
+		std::atomic<std::uint64_t> allocations{ 0 };
+		std::atomic<std::uint64_t> bytes{ 0 };
+		std::atomic<std::uint64_t> frees{ 0 };
+		std::atomic<std::int64_t> live_bytes{ 0 };
+		std::atomic<std::int64_t> peak_live_bytes{ 0 };
+		std::array<std::atomic<std::uint64_t>, playground::alloc_profiler::SIZE_BUCKETS> size_histogram{};
+	};
+
+	std::array<site_counters, SITES> counters;
+	std::atomic<std::uint64_t> interval{ 0 };
+	std::atomic<std::int64_t> window_start_ns{ 0 };
+	std::atomic<std::uint16_t> epoch{ 0 };
+
+	thread_local site current_site = site::rpc_runtime;
+	thread_local std::int64_t bytes_until_sample = 0;
+	thread_local bool countdown_started = false;
+	thread_local std::uint64_t random_state = 0;
+
+	/// Tells apart threads which reuse the thread-local storage of exited ones
+	std::atomic<std::uint64_t> thread_seeds{ 0 };
+
+	[[nodiscard]] std::int64_t now_ns() noexcept
+	{
+		const auto now = std::chrono::steady_clock::now().time_since_epoch();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+	}
+
+	/// Uniform in (0, 1], xorshift seeded per thread from a counter and the address of the state
+	[[nodiscard]] double next_uniform() noexcept
+	{
+		if (random_state == 0) {
+			// splitmix64 spreads the consecutive counter values over the whole state
+			auto seed = thread_seeds.fetch_add(0x9E3779B97F4A7C15, std::memory_order_relaxed) ^ reinterpret_cast<std::uintptr_t>(&random_state);
+			seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9;
+			seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EB;
+			random_state = (seed ^ (seed >> 31)) | 1;
+		}
+
+		random_state ^= random_state << 13;
+		random_state ^= random_state >> 7;
+		random_state ^= random_state << 17;
+		return static_cast<double>((random_state >> 11) + 1) * 0x1.0p-53;
+	}
+
+	/// Exponentially distributed gaps make the sampling a Poisson process over allocated bytes,
+	/// so allocation patterns cannot alias with a fixed stride
+	[[nodiscard]] std::int64_t next_sample_gap(std::uint64_t mean) noexcept
+	{
+		if (mean <= playground::alloc_profiler::SAMPLE_ALL)
+			return 0;
+
+		const double gap = -std::log(next_uniform()) * static_cast<double>(mean);
+		return static_cast<std::int64_t>(std::min(gap, static_cast<double>(std::numeric_limits<std::int32_t>::max())));
+	}
+
+	/// Decides whether this allocation is sampled, returns its weight in allocations or 0
+	[[nodiscard]] std::uint32_t sample(size_t size) noexcept
+	{
+		const auto mean = interval.load(std::memory_order_relaxed);
+		if (mean == 0)
+			return 0;
+
+		// A countdown starting at zero would sample the first allocation of every thread and
+		// overweight short-lived threads, it starts with a gap drawn like every later one
+		if (!countdown_started) {
+			bytes_until_sample = next_sample_gap(mean);
+			countdown_started = true;
+		}
+
+		bytes_until_sample -= static_cast<std::int64_t>(size);
+		if (bytes_until_sample > 0)
+			return 0;
+
+		bytes_until_sample = next_sample_gap(mean);
+
+		// An allocation of `size` bytes is sampled with probability 1 - exp(-size / mean)
+		if (mean <= playground::alloc_profiler::SAMPLE_ALL || size == 0)
+			return 1;
+
+		const double probability = -std::expm1(-static_cast<double>(size) / static_cast<double>(mean));
+		return static_cast<std::uint32_t>(std::clamp(std::round(1.0 / probability), 1.0, static_cast<double>(UINT32_MAX)));
+	}
+
+	void add_live(site_counters& c, std::int64_t delta) noexcept
+	{
+		const auto live = c.live_bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+
+		auto peak = c.peak_live_bytes.load(std::memory_order_relaxed);
+		while (live > peak && !c.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+		}
+	}
+
+	[[nodiscard]] std::uint64_t record_sample(site site, size_t size, std::uint32_t weight) noexcept
+	{
+		auto& c = counters[static_cast<size_t>(site)];
+		const auto weighted_bytes = static_cast<std::uint64_t>(size) * weight;
+
+		c.allocations.fetch_add(weight, std::memory_order_relaxed);
+		c.bytes.fetch_add(weighted_bytes, std::memory_order_relaxed);
+
+		const size_t bucket = size == 0 ? 0 : std::min<size_t>(std::bit_width(size) - 1, c.size_histogram.size() - 1);
+		c.size_histogram[bucket].fetch_add(weight, std::memory_order_relaxed);
+
+		return weighted_bytes;
+	}
+}
+
+namespace playground::alloc_profiler
+{
+	void set_sample_interval(std::uint64_t bytes) noexcept
+	{
+		if (window_start_ns.load(std::memory_order_relaxed) == 0)
+			window_start_ns.store(now_ns(), std::memory_order_relaxed);
+
+		interval.store(bytes, std::memory_order_relaxed);
+	}
+
+	std::uint64_t sample_interval() noexcept
+	{
+		return interval.load(std::memory_order_relaxed);
+	}
+
+	void reset() noexcept
+	{
+		epoch.fetch_add(1, std::memory_order_relaxed);
+
+		for (auto& c : counters)
+		{
+			c.allocations.store(0, std::memory_order_relaxed);
+			c.bytes.store(0, std::memory_order_relaxed);
+			c.frees.store(0, std::memory_order_relaxed);
+			c.live_bytes.store(0, std::memory_order_relaxed);
+			c.peak_live_bytes.store(0, std::memory_order_relaxed);
+			for (auto& bucket : c.size_histogram)
+				bucket.store(0, std::memory_order_relaxed);
+		}
+
+		window_start_ns.store(now_ns(), std::memory_order_relaxed);
+	}
+
+	site_stats stats(site site) noexcept
+	{
+		site_stats result;
+		if (static_cast<size_t>(site) >= SITES)
+			return result;
+
+		const auto& c = counters[static_cast<size_t>(site)];
+		result.allocations = c.allocations.load(std::memory_order_relaxed);
+		result.bytes = c.bytes.load(std::memory_order_relaxed);
+		result.frees = c.frees.load(std::memory_order_relaxed);
+		result.live_bytes = static_cast<std::uint64_t>(std::max<std::int64_t>(c.live_bytes.load(std::memory_order_relaxed), 0));
+		result.peak_live_bytes = static_cast<std::uint64_t>(c.peak_live_bytes.load(std::memory_order_relaxed));
+
+		for (size_t i = 0; i < result.size_histogram.size(); ++i)
+			result.size_histogram[i] = c.size_histogram[i].load(std::memory_order_relaxed);
+
+		if (const auto start = window_start_ns.load(std::memory_order_relaxed); start != 0) {
+			const auto elapsed_ns = std::max<std::int64_t>(now_ns() - start, 1);
+			result.allocations_per_second = static_cast<std::uint64_t>(static_cast<double>(result.allocations) * 1e9 / static_cast<double>(elapsed_ns));
+		}
+
+		return result;
+	}
+
+	void* allocate(size_t size) noexcept
+	{
+		if (size > std::numeric_limits<size_t>::max() - sizeof(block_header))
+			return nullptr;
+
+		auto* header = static_cast<block_header*>(std::malloc(sizeof(block_header) + size));
+		if (header == nullptr)
+			return nullptr;
+
+		*header = { .site = static_cast<std::uint16_t>(current_site) };
+
+		if (const auto weight = sample(size); weight != 0) {
+			header->weighted_bytes = record_sample(current_site, size, weight);
+			header->weighted_count = weight;
+			header->epoch = epoch.load(std::memory_order_relaxed);
+			add_live(counters[static_cast<size_t>(current_site)], static_cast<std::int64_t>(header->weighted_bytes));
+		}
+
+		return header + 1;
+	}
+
+	void free(void* ptr) noexcept
+	{
+		if (ptr == nullptr)
+			return;
+
+		auto* header = static_cast<block_header*>(ptr) - 1;
+
+		if (header->weighted_bytes != 0 && header->site < SITES && header->epoch == epoch.load(std::memory_order_relaxed)) {
+			auto& c = counters[header->site];
+			c.frees.fetch_add(header->weighted_count, std::memory_order_relaxed);
+			add_live(c, -static_cast<std::int64_t>(header->weighted_bytes));
+		}
+
+		std::free(header);
+	}
+
+	void record_handover(site site, size_t size) noexcept
+	{
+		if (static_cast<size_t>(site) >= SITES)
+			return;
+
+		if (const auto weight = sample(size); weight != 0)
+			std::ignore = record_sample(site, size, weight);
+	}
+
+	site_scope::site_scope(site site) noexcept
+		: previous_(current_site)
+	{
+		current_site = site;
+	}
+
+	site_scope::~site_scope()
+	{
+		current_site = previous_;
+	}
+}
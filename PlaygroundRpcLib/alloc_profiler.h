@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Sampling allocation profiler for the buffers crossing the RPC and DLL boundaries. Allocations
+/// are sampled by bytes, about one per `sample_interval` bytes allocated, and every sample stands
+/// for the allocations it represents, so totals are unbiased estimates. With sampling off an
+/// allocation costs a thread-local countdown and a 16 byte header.
+namespace playground::alloc_profiler
+{
+	enum class site : std::uint32_t {
+		/// `MIDL_user_allocate` called by the NDR engine, e.g. unmarshalled [out] buffers on the client
+		rpc_runtime,
+		/// Replies the server copies into RPC buffers
+		server_reply,
+		/// Strings returned by DLL exports, freed by the caller
+		co_task_string,
+		/// Byte buffers returned by DLL exports, freed by the caller
+		co_task_bytes,
+		count,
+	};
+
+	/// Power-of-two size classes, bucket `i` holds sizes in [2^i, 2^(i+1))
+	constexpr size_t SIZE_BUCKETS = 32;
+
+	/// Every allocation is sampled
+	constexpr std::uint64_t SAMPLE_ALL = 1;
+
+	struct site_stats {
+		std::uint64_t allocations = 0;
+		std::uint64_t bytes = 0;
+		std::uint64_t frees = 0;
+		/// Only tracked for sites whose frees are seen, CoTaskMem buffers belong to the caller
+		std::uint64_t live_bytes = 0;
+		std::uint64_t peak_live_bytes = 0;
+		std::uint64_t allocations_per_second = 0;
+		std::array<std::uint64_t, SIZE_BUCKETS> size_histogram{};
+	};
+
+	/// 0 turns sampling off, `SAMPLE_ALL` records every allocation exactly
+	void set_sample_interval(std::uint64_t bytes) noexcept;
+
+	[[nodiscard]] std::uint64_t sample_interval() noexcept;
+
+	/// Zeroes all sites and restarts the rate window. Blocks allocated before the reset are not
+	/// subtracted from the live bytes when they are freed.
+	void reset() noexcept;
+
+	[[nodiscard]] site_stats stats(site site) noexcept;
+
+	/// `malloc` with a header remembering the site, pair with `free`. The site is the innermost
+	/// `site_scope` of the thread, `rpc_runtime` without one.
+	[[nodiscard]] void* allocate(size_t size) noexcept;
+
+	void free(void* ptr) noexcept;
+
+	/// For allocations made elsewhere and handed over, e.g. CoTaskMem buffers returned to C#
+	void record_handover(site site, size_t size) noexcept;
+
+	/// Tags the `allocate` calls of this thread for its lifetime
+	class site_scope {
+	public:
+		explicit site_scope(site site) noexcept;
+		~site_scope();
+
+		site_scope(const site_scope&) = delete;
+		site_scope& operator=(const site_scope&) = delete;
+
+	private:
+		site previous_;
+	};
+}
@@ -0,0 +1,118 @@
+#include "batch_dispatcher.h"
+
+#include "../Common/defer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+namespace playground
+{
+	struct batch_dispatcher::batch {
+		std::vector<batch_request> requests;
+		std::vector<char*> replies;
+		size_t capacity = 0;
+		bool closed = false;
+		bool done = false;
+
+		/// What the callback threw, rethrown by every request of the batch
+		std::exception_ptr error;
+
+		/// Wakes the leader when the batch fills up, and everybody once the replies are in
+		std::condition_variable changed;
+	};
+
+	char* batch_dispatcher::call(pass_and_get_string_batch_t callback, const char* str)
+	{
+		std::unique_lock lock(mutex_);
+
+		const bool leader = open_ == nullptr;
+		if (leader) {
+			open_ = std::make_shared<batch>();
+			open_->capacity = std::max<size_t>(options_.max_batch_size, 1);
+			open_->requests.reserve(open_->capacity);
+		}
+
+		// Keeps the batch alive after it stops being the open one
+		const auto current = open_;
+		const size_t index = current->requests.size();
+		current->requests.push_back({ str, std::strlen(str) });
+
+		if (current->requests.size() >= current->capacity) {
+			current->closed = true;
+			open_.reset();
+			++stats_.full_batches;
+			current->changed.notify_all();
+		}
+
+		if (!leader) {
+			current->changed.wait(lock, [&] { return current->done; });
+
+			if (current->error)
+				std::rethrow_exception(current->error);
+
+			return current->replies[index];
+		}
+
+		current->changed.wait_for(lock, options_.window, [&] { return current->closed; });
+		if (!current->closed) {
+			current->closed = true;
+			open_.reset();
+		}
+
+		++stats_.batches;
+		stats_.requests += current->requests.size();
+
+		// Nobody touches a closed batch until it is done, the callback runs unlocked
+		lock.unlock();
+		{
+			// The other requests are woken however the callback ends
+			defer(lock.lock(); current->done = true; current->changed.notify_all());
+
+			try {
+				current->replies.assign(current->requests.size(), nullptr);
+				callback(current->requests.data(), current->replies.data(), current->requests.size());
+			}
+			catch (...) {
+				current->error = std::current_exception();
+				release_replies(*current);
+			}
+		}
+
+		if (current->error)
+			std::rethrow_exception(current->error);
+
+		return current->replies[index];
+	}
+
+	void batch_dispatcher::release_replies(batch& failed) const noexcept
+	{
+		// Replies set before the callback failed are not handed out
+		for (auto& reply : failed.replies)
+		{
+			if (reply != nullptr && free_reply_ != nullptr)
+				free_reply_(reply);
+
+			reply = nullptr;
+		}
+	}
+
+	void batch_dispatcher::set_options(batch_options options)
+	{
+		std::scoped_lock lock(mutex_);
+		options_ = options;
+	}
+
+	batch_options batch_dispatcher::options() const
+	{
+		std::scoped_lock lock(mutex_);
+		return options_;
+	}
+
+	batch_stats batch_dispatcher::stats() const
+	{
+		std::scoped_lock lock(mutex_);
+		return stats_;
+	}
+}
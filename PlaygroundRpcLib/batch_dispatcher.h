@@ -0,0 +1,58 @@
+#pragma once
+
+#include "callbacks.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace playground
+{
+	struct batch_options {
+		/// How long the request opening a batch waits for others to join it
+		std::chrono::microseconds window{ 200 };
+		size_t max_batch_size = 32;
+	};
+
+	struct batch_stats {
+		std::uint64_t batches = 0;
+		std::uint64_t requests = 0;
+
+		/// Batches closed by reaching `max_batch_size` rather than by the window running out
+		std::uint64_t full_batches = 0;
+	};
+
+	/// Groups concurrently arriving requests into batches for a `pass_and_get_string_batch_t`
+	/// callback. There is no thread of its own: the RPC thread whose request opens a batch waits
+	/// up to the window, or until the batch is full, calls the callback for the whole group and
+	/// wakes the threads of the other requests, which each pick up their reply.
+	class batch_dispatcher {
+	public:
+		/// `free_reply` releases the replies of a batch whose callback failed, null leaves them to leak
+		explicit batch_dispatcher(void (*free_reply)(char* reply) = nullptr) noexcept : free_reply_(free_reply) {}
+
+		/// Returns the `CoTaskMemAlloc` reply the callback set for `str`, or null. When the callback
+		/// throws, every request of its batch rethrows the exception.
+		[[nodiscard]] char* call(pass_and_get_string_batch_t callback, const char* str);
+
+		void set_options(batch_options options);
+		[[nodiscard]] batch_options options() const;
+
+		[[nodiscard]] batch_stats stats() const;
+
+	private:
+		struct batch;
+
+		void release_replies(batch& failed) const noexcept;
+
+		void (*free_reply_)(char* reply) = nullptr;
+
+		mutable std::mutex mutex_;
+		std::shared_ptr<batch> open_;
+		batch_options options_;
+		batch_stats stats_;
+	};
+}
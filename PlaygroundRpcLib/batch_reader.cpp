@@ -0,0 +1,322 @@
+#include "batch_reader.h"
+
+#include "../Common/defer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	/// Large files are split so a single file does not serialize the whole batch
+	constexpr size_t MAX_READ_SIZE = 8 * 1024 * 1024;
+
+	struct read_request {
+		size_t file = 0;
+		std::uint64_t offset = 0;
+		size_t length = 0;
+	};
+
+	struct packed_buffer {
+		std::byte* data = nullptr;
+		std::uint64_t size = 0;
+	};
+
+	/// Assigns content offsets to readable files and allocates the packed buffer
+	[[nodiscard]] packed_buffer allocate_packed(std::span<playground::packed_file_entry> entries, const playground::packed_files_allocator& allocate)
+	{
+		std::uint64_t offset = sizeof(playground::packed_files_header) + entries.size() * sizeof(playground::packed_file_entry);
+
+		for (auto& entry : entries)
+		{
+			if (entry.status != 0) {
+				entry.size = 0;
+				continue;
+			}
+
+			entry.offset = offset;
+			offset += entry.size;
+		}
+
+		if (offset > SIZE_MAX)
+			throw std::bad_alloc{};
+
+		return { allocate(static_cast<size_t>(offset)), offset };
+	}
+
+	[[nodiscard]] std::vector<read_request> split_requests(std::span<const playground::packed_file_entry> entries)
+	{
+		std::vector<read_request> requests;
+
+		for (size_t i = 0; i < entries.size(); ++i)
+		{
+			if (entries[i].status != 0)
+				continue;
+
+			for (std::uint64_t offset = 0; offset < entries[i].size; offset += MAX_READ_SIZE)
+				requests.push_back({ i, offset, static_cast<size_t>(std::min<std::uint64_t>(MAX_READ_SIZE, entries[i].size - offset)) });
+		}
+
+		return requests;
+	}
+
+	void write_packed(const packed_buffer& buffer, std::span<playground::packed_file_entry> entries)
+	{
+		// Space of files which failed while being read stays in the buffer unused
+		for (auto& entry : entries)
+		{
+			if (entry.status != 0)
+				entry.size = 0;
+		}
+
+		const playground::packed_files_header header{
+			.count = static_cast<std::uint32_t>(entries.size()),
+			.total_size = buffer.size,
+		};
+
+		std::memcpy(buffer.data, &header, sizeof(header));
+		if (!entries.empty())
+			std::memcpy(buffer.data + sizeof(header), entries.data(), entries.size_bytes());
+	}
+}
+
+namespace playground
+{
+#ifdef _WIN32
+	std::byte* read_files_packed(
+		std::span<const char* const> paths,
+		size_t queue_depth,
+		const packed_files_allocator& allocate,
+		const packed_files_deallocator& deallocate)
+	{
+		if (paths.size() > UINT32_MAX)
+			throw std::invalid_argument{ "too many paths" };
+
+		auto port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+		if (port == nullptr)
+			throw std::system_error(GetLastError(), std::system_category(), "CreateIoCompletionPort failed");
+
+		defer(std::ignore = CloseHandle(port));
+
+		std::vector<packed_file_entry> entries(paths.size());
+		std::vector<HANDLE> files(paths.size(), INVALID_HANDLE_VALUE);
+
+		defer(for (auto file : files) if (file != INVALID_HANDLE_VALUE) std::ignore = CloseHandle(file));
+
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			files[i] = CreateFileA(
+				paths[i],
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+
+			LARGE_INTEGER file_size{};
+			if (files[i] == INVALID_HANDLE_VALUE
+				|| !GetFileSizeEx(files[i], &file_size)
+				|| CreateIoCompletionPort(files[i], port, i, 0) == nullptr)
+			{
+				entries[i].status = GetLastError();
+				continue;
+			}
+
+			entries[i].size = static_cast<std::uint64_t>(file_size.QuadPart);
+		}
+
+		const auto buffer = allocate_packed(entries, allocate);
+
+		bool handed_over = false;
+		defer(if (!handed_over) deallocate(buffer.data));
+
+		const auto requests = split_requests(entries);
+
+		struct io_slot {
+			OVERLAPPED overlapped{};
+			size_t request = 0;
+			bool pending = false;
+		};
+
+		std::vector<io_slot> slots(std::clamp<size_t>(queue_depth, 1, std::max<size_t>(requests.size(), 1)));
+		size_t next_request = 0;
+		size_t in_flight = 0;
+
+		// The kernel would keep writing into the buffer and the slots after an unwind. Completion
+		// packets of cancelled reads are left in the port, which is closed afterwards.
+		auto cancel_pending = [&]() noexcept {
+			for (auto& slot : slots)
+			{
+				if (slot.pending)
+					std::ignore = CancelIoEx(files[requests[slot.request].file], &slot.overlapped);
+			}
+
+			for (auto& slot : slots)
+			{
+				while (slot.pending && !HasOverlappedIoCompleted(&slot.overlapped))
+					Sleep(1);
+			}
+		};
+
+		defer(if (in_flight > 0) cancel_pending());
+
+		auto issue = [&](io_slot& slot) {
+			while (next_request < requests.size())
+			{
+				const auto& request = requests[next_request];
+				slot.request = next_request++;
+
+				if (entries[request.file].status != 0)
+					continue;
+
+				slot.overlapped = {};
+				slot.overlapped.Offset = static_cast<DWORD>(request.offset);
+				slot.overlapped.OffsetHigh = static_cast<DWORD>(request.offset >> 32);
+
+				auto* target = buffer.data + entries[request.file].offset + request.offset;
+				if (!ReadFile(files[request.file], target, static_cast<DWORD>(request.length), nullptr, &slot.overlapped)
+					&& GetLastError() != ERROR_IO_PENDING)
+				{
+					entries[request.file].status = GetLastError();
+					continue;
+				}
+
+				slot.pending = true;
+				++in_flight;
+				return;
+			}
+		};
+
+		for (auto& slot : slots)
+			issue(slot);
+
+		while (in_flight > 0)
+		{
+			DWORD transferred = 0;
+			ULONG_PTR key = 0;
+			OVERLAPPED* overlapped = nullptr;
+			const bool ok = GetQueuedCompletionStatus(port, &transferred, &key, &overlapped, INFINITE);
+
+			// Only possible when the port itself fails, every read targets a live slot otherwise
+			if (overlapped == nullptr)
+				throw std::system_error(GetLastError(), std::system_category(), "GetQueuedCompletionStatus failed");
+
+			auto& slot = *CONTAINING_RECORD(overlapped, io_slot, overlapped);
+			slot.pending = false;
+			--in_flight;
+
+			const auto& request = requests[slot.request];
+
+			if (!ok)
+				entries[request.file].status = GetLastError();
+			else if (transferred != request.length)
+				entries[request.file].status = ERROR_HANDLE_EOF;
+
+			issue(slot);
+		}
+
+		write_packed(buffer, entries);
+		handed_over = true;
+		return buffer.data;
+	}
+#else
+	std::byte* read_files_packed(
+		std::span<const char* const> paths,
+		size_t queue_depth,
+		const packed_files_allocator& allocate,
+		const packed_files_deallocator& deallocate)
+	{
+		if (paths.size() > UINT32_MAX)
+			throw std::invalid_argument{ "too many paths" };
+
+		std::vector<packed_file_entry> entries(paths.size());
+		std::vector<int> files(paths.size(), -1);
+
+		defer(for (auto fd : files) if (fd >= 0) std::ignore = ::close(fd));
+
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			struct stat status {};
+			files[i] = ::open(paths[i], O_RDONLY | O_CLOEXEC);
+			if (files[i] < 0 || ::fstat(files[i], &status) != 0) {
+				entries[i].status = static_cast<std::uint32_t>(errno);
+				continue;
+			}
+
+			entries[i].size = static_cast<std::uint64_t>(status.st_size);
+		}
+
+		const auto buffer = allocate_packed(entries, allocate);
+
+		bool handed_over = false;
+		defer(if (!handed_over) deallocate(buffer.data));
+
+		const auto requests = split_requests(entries);
+
+		std::vector<std::atomic<std::uint32_t>> statuses(entries.size());
+		std::atomic<size_t> next_request{ 0 };
+
+		auto work = [&] {
+			for (size_t r = next_request.fetch_add(1); r < requests.size(); r = next_request.fetch_add(1))
+			{
+				const auto& request = requests[r];
+				if (statuses[request.file].load(std::memory_order_relaxed) != 0)
+					continue;
+
+				auto* target = buffer.data + entries[request.file].offset + request.offset;
+				size_t filled = 0;
+				while (filled < request.length)
+				{
+					const auto n = ::pread(files[request.file], target + filled, request.length - filled, static_cast<off_t>(request.offset + filled));
+					if (n < 0 && errno == EINTR)
+						continue;
+
+					if (n <= 0) {
+						statuses[request.file].store(n < 0 ? static_cast<std::uint32_t>(errno) : EIO, std::memory_order_relaxed);
+						break;
+					}
+
+					filled += static_cast<size_t>(n);
+				}
+			}
+		};
+
+		{
+			// The calling thread is one of the readers
+			const size_t workers_count = std::clamp<size_t>(queue_depth, 1, std::max<size_t>(requests.size(), 1)) - 1;
+			std::vector<std::jthread> workers;
+			workers.reserve(workers_count);
+			for (size_t i = 0; i < workers_count; ++i)
+				workers.emplace_back(work);
+
+			work();
+		}
+
+		for (size_t i = 0; i < entries.size(); ++i)
+		{
+			if (auto status = statuses[i].load(std::memory_order_relaxed); status != 0)
+				entries[i].status = status;
+		}
+
+		write_packed(buffer, entries);
+		handed_over = true;
+		return buffer.data;
+	}
+#endif
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+/// Packed result of reading many files at once, one contiguous buffer laid out as:
+///   packed_files_header
+///   packed_file_entry[count], in the order of the requested paths
+///   file contents, each at its entry's offset from the beginning of the buffer
+namespace playground
+{
+	struct packed_files_header {
+		std::uint32_t count = 0;
+		std::uint32_t reserved = 0;
+		std::uint64_t total_size = 0;
+	};
+
+	struct packed_file_entry {
+		/// 0 on success, otherwise a system error code; a failed file has no content
+		std::uint32_t status = 0;
+		std::uint32_t reserved = 0;
+		std::uint64_t offset = 0;
+		std::uint64_t size = 0;
+	};
+
+	/// Returns storage for the whole packed result, or throws `std::bad_alloc`
+	using packed_files_allocator = std::function<std::byte* (size_t size)>;
+
+	/// Frees storage from the allocator when the batch fails after allocating it
+	using packed_files_deallocator = std::function<void(std::byte* data)>;
+
+	/// Reads all files concurrently, with at most `queue_depth` reads in flight, straight into a single
+	/// buffer obtained from `allocate`. Overlapped I/O on a completion port on Windows, a pool of
+	/// `pread` workers elsewhere. Per-file failures are reported in the entries, not thrown. When the
+	/// batch as a whole fails, reads in flight are cancelled and waited for, and the buffer is handed
+	/// to `deallocate`, before the exception propagates.
+	[[nodiscard]] std::byte* read_files_packed(
+		std::span<const char* const> paths,
+		size_t queue_depth,
+		const packed_files_allocator& allocate,
+		const packed_files_deallocator& deallocate);
+}
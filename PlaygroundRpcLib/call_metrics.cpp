@@ -0,0 +1,243 @@
+#include "call_metrics.h"
+
+#include "call_trace.h"
+#include "flight_recorder.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	using playground::metrics::method;
+	using playground::metrics::side;
+
+	constexpr size_t SIDES = static_cast<size_t>(side::count);
+	constexpr size_t METHODS = static_cast<size_t>(method::count);
+
+	struct method_shard {
+		std::atomic<std::uint64_t> calls{ 0 };
+		std::atomic<std::uint64_t> errors{ 0 };
+		std::atomic<std::uint64_t> bytes_in{ 0 };
+		std::atomic<std::uint64_t> bytes_out{ 0 };
+		std::atomic<std::uint64_t> total_ns{ 0 };
+		playground::latency_histogram latency;
+	};
+
+	/// Written by a single thread at a time, read by any
+	struct shard {
+		std::array<std::array<method_shard, METHODS>, SIDES> methods;
+	};
+
+	void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) noexcept
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	/// Shards are never freed, the shard of an exited thread keeps its counts and goes to the next
+	/// new thread, so the number of shards is bounded by the peak number of threads
+	class shard_registry {
+	public:
+		shard* acquire()
+		{
+			std::scoped_lock lock(mutex_);
+
+			if (!free_.empty()) {
+				auto* s = free_.back();
+				free_.pop_back();
+				return s;
+			}
+
+			return shards_.emplace_back(std::make_unique<shard>()).get();
+		}
+
+		void release(shard* s)
+		{
+			std::scoped_lock lock(mutex_);
+			free_.push_back(s);
+		}
+
+		template <class Fn>
+		void for_each(Fn&& fn)
+		{
+			std::scoped_lock lock(mutex_);
+			for (const auto& s : shards_)
+				fn(*s);
+		}
+
+	private:
+		std::mutex mutex_;
+		std::vector<std::unique_ptr<shard>> shards_;
+		std::vector<shard*> free_;
+	};
+
+	shard_registry& get_registry()
+	{
+		// Leaked on purpose, threads may still record while static destructors run
+		static auto* registry = new shard_registry();
+		return *registry;
+	}
+
+	struct thread_shard {
+		shard* s = get_registry().acquire();
+		~thread_shard() { get_registry().release(s); }
+	};
+
+	method_shard& local_method(side side, method method)
+	{
+		thread_local thread_shard local;
+		return local.s->methods[static_cast<size_t>(side)][static_cast<size_t>(method)];
+	}
+
+	[[nodiscard]] bool is_valid(side side, method method) noexcept
+	{
+		return static_cast<size_t>(side) < SIDES && static_cast<size_t>(method) < METHODS;
+	}
+
+	thread_local playground::metrics::call_scope* current_call = nullptr;
+
+	constexpr std::array<const char*, static_cast<size_t>(playground::metrics::phase::count)> PHASE_NAMES{
+		"callback",
+		"reply copy",
+		"take reply",
+	};
+}
+
+namespace playground::metrics
+{
+	void record(side side, method method, std::uint64_t latency_ns, std::uint64_t bytes_in, std::uint64_t bytes_out, bool failed) noexcept
+	{
+		if (!is_valid(side, method))
+			return;
+
+		try {
+			auto& m = local_method(side, method);
+			add(m.calls, 1);
+			add(m.bytes_in, bytes_in);
+			add(m.bytes_out, bytes_out);
+			add(m.total_ns, latency_ns);
+			if (failed)
+				add(m.errors, 1);
+
+			m.latency.record(latency_ns);
+		}
+		catch (const std::exception&) {
+			// Out of memory for a new shard, metrics must never fail the call itself
+		}
+	}
+
+	method_snapshot snapshot(side side, method method)
+	{
+		method_snapshot result;
+		if (!is_valid(side, method))
+			return result;
+
+		latency_counts counts;
+		get_registry().for_each([&](const shard& s) {
+			const auto& m = s.methods[static_cast<size_t>(side)][static_cast<size_t>(method)];
+			result.calls += m.calls.load(std::memory_order_relaxed);
+			result.errors += m.errors.load(std::memory_order_relaxed);
+			result.bytes_in += m.bytes_in.load(std::memory_order_relaxed);
+			result.bytes_out += m.bytes_out.load(std::memory_order_relaxed);
+			result.total_ns += m.total_ns.load(std::memory_order_relaxed);
+			m.latency.add_to(counts);
+		});
+
+		result.max_ns = counts.max;
+		result.p50_ns = counts.value_at_percentile(50.0);
+		result.p90_ns = counts.value_at_percentile(90.0);
+		result.p99_ns = counts.value_at_percentile(99.0);
+		result.p999_ns = counts.value_at_percentile(99.9);
+		return result;
+	}
+
+	latency_counts latency(side side, method method)
+	{
+		latency_counts counts;
+		if (!is_valid(side, method))
+			return counts;
+
+		get_registry().for_each([&](const shard& s) {
+			s.methods[static_cast<size_t>(side)][static_cast<size_t>(method)].latency.add_to(counts);
+		});
+		return counts;
+	}
+
+	void reset() noexcept
+	{
+		try {
+			get_registry().for_each([](shard& s) {
+				for (auto& per_side : s.methods)
+				{
+					for (auto& m : per_side)
+					{
+						m.calls.store(0, std::memory_order_relaxed);
+						m.errors.store(0, std::memory_order_relaxed);
+						m.bytes_in.store(0, std::memory_order_relaxed);
+						m.bytes_out.store(0, std::memory_order_relaxed);
+						m.total_ns.store(0, std::memory_order_relaxed);
+						m.latency.reset();
+					}
+				}
+			});
+		}
+		catch (const std::exception&) {
+			// Locking the registry failed, nothing was reset
+		}
+	}
+
+	call_scope::call_scope(side side, method method, std::uint64_t request_bytes, std::uint64_t call_id) noexcept
+		: side_(side), method_(method), call_id_(call_id), request_bytes_(request_bytes), start_(std::chrono::steady_clock::now()), previous_(current_call)
+	{
+		current_call = this;
+	}
+
+	call_scope::~call_scope()
+	{
+		current_call = previous_;
+
+		const auto elapsed = std::chrono::steady_clock::now() - start_;
+		const auto latency_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+		// The request is sent by the client and received by the server
+		const bool is_client = side_ == side::client;
+		const auto bytes_in = is_client ? reply_bytes_ : request_bytes_;
+		const auto bytes_out = is_client ? request_bytes_ : reply_bytes_;
+
+		record(side_, method_, latency_ns, bytes_in, bytes_out, status_ != 0);
+
+		flight_recorder::record({
+			.end_ns = trace::now_ns(),
+			.call_id = call_id_,
+			.side = side_,
+			.method = method_,
+			.status = status_,
+			.bytes_in = bytes_in,
+			.bytes_out = bytes_out,
+			.total_ns = latency_ns,
+			.phase_ns = phase_ns_,
+		});
+	}
+
+	call_scope* call_scope::current() noexcept
+	{
+		return current_call;
+	}
+
+	phase_scope::phase_scope(phase phase, std::uint64_t call_id) noexcept
+		: phase_(phase), call_id_(call_id), start_ns_(trace::now_ns())
+	{
+	}
+
+	phase_scope::~phase_scope()
+	{
+		const auto end_ns = trace::now_ns();
+
+		if (current_call != nullptr)
+			current_call->add_phase(phase_, end_ns - start_ns_);
+
+		if (trace::is_enabled())
+			trace::record(PHASE_NAMES[static_cast<size_t>(phase_)], call_id_, start_ns_, end_ns);
+	}
+}
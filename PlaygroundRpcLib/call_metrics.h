@@ -0,0 +1,117 @@
+#pragma once
+
+#include "latency_histogram.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+/// Per-method call counters and latency histograms for both ends of the interface. Every thread
+/// records into its own shard without locking, shards are merged when a snapshot is taken.
+namespace playground::metrics
+{
+	enum class side : std::uint32_t {
+		client,
+		server,
+		count,
+	};
+
+	/// One entry per method of the RPC interface
+	enum class method : std::uint32_t {
+		pass_and_get_string,
+		pass_and_get_bytes,
+		pass_hash_and_get_string,
+		pass_hashed_and_get_string,
+		pass_delta_and_get_string,
+		invoke,
+		count,
+	};
+
+	/// Parts of a call timed separately, see `phase_scope`
+	enum class phase : std::uint32_t {
+		/// The managed callback on the server
+		callback,
+		/// Copying the callback result into the RPC reply buffer on the server
+		reply_copy,
+		/// Copying the unmarshalled reply out of the RPC buffer on the client
+		take_reply,
+		count,
+	};
+
+	/// Bytes are counted from the point of view of the side, `bytes_out` are the bytes it sent
+	struct method_snapshot {
+		std::uint64_t calls = 0;
+		std::uint64_t errors = 0;
+		std::uint64_t bytes_in = 0;
+		std::uint64_t bytes_out = 0;
+		std::uint64_t total_ns = 0;
+		std::uint64_t max_ns = 0;
+		std::uint64_t p50_ns = 0;
+		std::uint64_t p90_ns = 0;
+		std::uint64_t p99_ns = 0;
+		std::uint64_t p999_ns = 0;
+	};
+
+	void record(side side, method method, std::uint64_t latency_ns, std::uint64_t bytes_in, std::uint64_t bytes_out, bool failed) noexcept;
+
+	[[nodiscard]] method_snapshot snapshot(side side, method method);
+
+	/// Merged latency buckets, for callers that want more than the percentiles of the snapshot
+	[[nodiscard]] latency_counts latency(side side, method method);
+
+	/// Zeroes all shards; calls recorded concurrently with the reset may be partially kept
+	void reset() noexcept;
+
+	/// Times one call from construction to `finish`. A scope left without `finish`, e.g. by an
+	/// exception, is recorded as failed. Completed calls also go to the flight recorder.
+	class call_scope {
+	public:
+		call_scope(side side, method method, std::uint64_t request_bytes, std::uint64_t call_id = 0) noexcept;
+		~call_scope();
+
+		call_scope(const call_scope&) = delete;
+		call_scope& operator=(const call_scope&) = delete;
+
+		/// Returns `status` so a call can be finished in its return statement
+		std::uint32_t finish(std::uint32_t status, std::uint64_t reply_bytes) noexcept
+		{
+			status_ = status;
+			reply_bytes_ = reply_bytes;
+			return status;
+		}
+
+		void add_phase(phase phase, std::uint64_t ns) noexcept
+		{
+			phase_ns_[static_cast<size_t>(phase)] += ns;
+		}
+
+		/// Innermost call of this thread, or null
+		[[nodiscard]] static call_scope* current() noexcept;
+
+	private:
+		side side_;
+		method method_;
+		std::uint64_t call_id_ = 0;
+		std::uint64_t request_bytes_ = 0;
+		std::uint64_t reply_bytes_ = 0;
+		std::uint32_t status_ = UINT32_MAX;
+		std::chrono::steady_clock::time_point start_;
+		std::array<std::uint64_t, static_cast<size_t>(phase::count)> phase_ns_{};
+		call_scope* previous_ = nullptr;
+	};
+
+	/// Times one phase of the current call, and records it as a trace span while tracing
+	class phase_scope {
+	public:
+		phase_scope(phase phase, std::uint64_t call_id) noexcept;
+		~phase_scope();
+
+		phase_scope(const phase_scope&) = delete;
+		phase_scope& operator=(const phase_scope&) = delete;
+
+	private:
+		phase phase_;
+		std::uint64_t call_id_;
+		std::uint64_t start_ns_;
+	};
+}
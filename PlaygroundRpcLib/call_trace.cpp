@@ -0,0 +1,265 @@
+#include "call_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	struct event {
+		const char* name = nullptr;
+		std::uint64_t call_id = 0;
+		std::uint64_t start_ns = 0;
+		std::uint64_t end_ns = 0;
+		std::uint32_t tid = 0;
+	};
+
+	/// Written only by its thread. The thread resets it lazily when it notices a new trace, so
+	/// `start` never touches a buffer another thread may be writing. `events` is only resized
+	/// before `generation` is published, and `generation` only changes under `control_mutex`.
+	struct thread_buffer {
+		std::vector<event> events;
+		std::atomic<size_t> count{ 0 };
+		std::atomic<std::uint64_t> dropped{ 0 };
+		std::atomic<std::uint64_t> generation{ 0 };
+	};
+
+	class buffer_registry {
+	public:
+		thread_buffer* acquire()
+		{
+			std::scoped_lock lock(mutex_);
+
+			if (!free_.empty()) {
+				auto* buffer = free_.back();
+				free_.pop_back();
+				return buffer;
+			}
+
+			return buffers_.emplace_back(std::make_unique<thread_buffer>()).get();
+		}
+
+		void release(thread_buffer* buffer)
+		{
+			std::scoped_lock lock(mutex_);
+			free_.push_back(buffer);
+		}
+
+		template <class Fn>
+		void for_each(Fn&& fn)
+		{
+			std::scoped_lock lock(mutex_);
+			for (const auto& buffer : buffers_)
+				fn(*buffer);
+		}
+
+	private:
+		std::mutex mutex_;
+		std::vector<std::unique_ptr<thread_buffer>> buffers_;
+		std::vector<thread_buffer*> free_;
+	};
+
+	buffer_registry& get_registry()
+	{
+		// Leaked on purpose, threads may still record while static destructors run
+		static auto* registry = new buffer_registry();
+		return *registry;
+	}
+
+	/// Serializes `start` with `to_chrome_json`, so no buffer is reset while it is being exported
+	std::mutex control_mutex;
+
+	std::atomic<std::uint64_t> generation{ 0 };
+	std::atomic<size_t> capacity{ playground::trace::DEFAULT_EVENTS_PER_THREAD };
+
+	[[nodiscard]] std::uint32_t thread_id() noexcept
+	{
+#ifdef _WIN32
+		return GetCurrentThreadId();
+#else
+		static std::atomic<std::uint32_t> counter{ 0 };
+		return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+#endif
+	}
+
+	/// Buffers outlive their threads and are reused, so the thread id is kept with every event
+	struct thread_slot {
+		thread_buffer* buffer = get_registry().acquire();
+		std::uint32_t tid = thread_id();
+		~thread_slot() { get_registry().release(buffer); }
+	};
+
+	[[nodiscard]] std::uint32_t process_id() noexcept
+	{
+#ifdef _WIN32
+		return GetCurrentProcessId();
+#else
+		return static_cast<std::uint32_t>(::getpid());
+#endif
+	}
+
+	void append_event(std::string& out, const char* phase, const event& e, std::uint32_t pid)
+	{
+		// Chrome expects microseconds
+		std::format_to(
+			std::back_inserter(out),
+			R"({{"name":"{}","cat":"rpc","ph":"{}","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{},"args":{{"call_id":"{:016x}"}}}},)",
+			e.name,
+			phase,
+			static_cast<double>(e.start_ns) / 1000.0,
+			static_cast<double>(e.end_ns - e.start_ns) / 1000.0,
+			pid,
+			e.tid,
+			e.call_id);
+	}
+
+	void append_flow(std::string& out, const char* phase, const event& e, std::uint32_t pid)
+	{
+		std::format_to(
+			std::back_inserter(out),
+			R"({{"name":"call","cat":"rpc","ph":"{}","bp":"e","id":"{:016x}","ts":{:.3f},"pid":{},"tid":{}}},)",
+			phase,
+			e.call_id,
+			static_cast<double>(e.start_ns) / 1000.0,
+			pid,
+			e.tid);
+	}
+}
+
+namespace playground::trace
+{
+	void start(size_t events_per_thread)
+	{
+		std::scoped_lock lock(control_mutex);
+
+		capacity.store(std::max<size_t>(events_per_thread, 1), std::memory_order_relaxed);
+		generation.fetch_add(1, std::memory_order_relaxed);
+		detail::enabled.store(true, std::memory_order_release);
+	}
+
+	void stop() noexcept
+	{
+		detail::enabled.store(false, std::memory_order_release);
+	}
+
+	std::uint64_t new_call_id() noexcept
+	{
+		// Random high bits tell processes apart, the counter tells calls of one process apart
+		static const std::uint64_t process_bits = [] {
+			std::random_device device;
+			return std::uint64_t{ device() } << 32;
+		}();
+		static std::atomic<std::uint32_t> counter{ 0 };
+
+		return process_bits | (counter.fetch_add(1, std::memory_order_relaxed) + 1);
+	}
+
+	std::uint64_t now_ns() noexcept
+	{
+		const auto now = std::chrono::steady_clock::now().time_since_epoch();
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+	}
+
+	void record(const char* name, std::uint64_t call_id, std::uint64_t start_ns, std::uint64_t end_ns) noexcept
+	{
+		try {
+			thread_local thread_slot slot;
+			auto& buffer = *slot.buffer;
+
+			const auto current = generation.load(std::memory_order_relaxed);
+			if (buffer.generation.load(std::memory_order_relaxed) != current) {
+				buffer.count.store(0, std::memory_order_relaxed);
+				buffer.dropped.store(0, std::memory_order_relaxed);
+				buffer.events.resize(capacity.load(std::memory_order_relaxed));
+
+				// Publishes the resized events to `to_chrome_json`
+				buffer.generation.store(current, std::memory_order_release);
+			}
+
+			const auto count = buffer.count.load(std::memory_order_relaxed);
+			if (count == buffer.events.size()) {
+				buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return;
+			}
+
+			buffer.events[count] = { name, call_id, start_ns, end_ns, slot.tid };
+			buffer.count.store(count + 1, std::memory_order_release);
+		}
+		catch (const std::exception&) {
+			// Out of memory for the buffer, tracing must never fail the call itself
+		}
+	}
+
+	std::string to_chrome_json()
+	{
+		std::unique_lock lock(control_mutex);
+
+		const auto current = generation.load(std::memory_order_relaxed);
+		std::vector<event> events;
+		std::uint64_t dropped = 0;
+
+		get_registry().for_each([&](thread_buffer& buffer) {
+			// A buffer of the current trace is not resized again while the lock is held, and only
+			// its published events are copied; one still being reset is skipped
+			if (buffer.generation.load(std::memory_order_acquire) != current)
+				return;
+
+			const auto count = buffer.count.load(std::memory_order_acquire);
+			events.insert(events.end(), buffer.events.begin(), buffer.events.begin() + count);
+
+			dropped += buffer.dropped.load(std::memory_order_relaxed);
+		});
+
+		lock.unlock();
+
+		std::ranges::sort(events, {}, &event::start_ns);
+
+		// Index of the last span of every call, where its flow arrow ends
+		std::unordered_map<std::uint64_t, size_t> last_of_call;
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			if (events[i].call_id != 0)
+				last_of_call[events[i].call_id] = i;
+		}
+
+		const auto pid = process_id();
+		std::unordered_map<std::uint64_t, bool> started;
+
+		std::string out = R"({"traceEvents":[)";
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			const auto& e = events[i];
+			append_event(out, "X", e, pid);
+
+			if (e.call_id == 0)
+				continue;
+
+			if (!std::exchange(started[e.call_id], true)) {
+				if (last_of_call[e.call_id] != i)
+					append_flow(out, "s", e, pid);
+			}
+			else {
+				append_flow(out, last_of_call[e.call_id] == i ? "f" : "t", e, pid);
+			}
+		}
+
+		if (out.back() == ',')
+			out.pop_back();
+
+		std::format_to(std::back_inserter(out), R"(],"displayTimeUnit":"ns","otherData":{{"dropped_events":{}}}}})", dropped);
+		return out;
+	}
+}
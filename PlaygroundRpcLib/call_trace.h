@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Optional timestamps of the phases of a call, linked across client and server by a call id that
+/// travels in the `call_context` of the request. Spans go to a per-thread buffer without locking;
+/// while tracing is stopped a span costs a single relaxed load.
+namespace playground::trace
+{
+	constexpr size_t DEFAULT_EVENTS_PER_THREAD = 64 * 1024;
+
+	namespace detail
+	{
+		inline std::atomic<bool> enabled{ false };
+	}
+
+	[[nodiscard]] inline bool is_enabled() noexcept
+	{
+		return detail::enabled.load(std::memory_order_relaxed);
+	}
+
+	/// Starts a new trace, discarding the events of the previous one. Each thread keeps at most
+	/// `events_per_thread` events, later ones are counted as dropped.
+	void start(size_t events_per_thread = DEFAULT_EVENTS_PER_THREAD);
+
+	void stop() noexcept;
+
+	/// Unique across processes, so client and server traces can be merged; never 0
+	[[nodiscard]] std::uint64_t new_call_id() noexcept;
+
+	/// Monotonic nanoseconds, comparable between processes on the same machine
+	[[nodiscard]] std::uint64_t now_ns() noexcept;
+
+	/// `name` must outlive the trace, in practice a string literal
+	void record(const char* name, std::uint64_t call_id, std::uint64_t start_ns, std::uint64_t end_ns) noexcept;
+
+	/// Chrome trace event JSON of everything recorded since `start`, viewable in chrome://tracing
+	/// and Perfetto. Spans sharing a call id are connected by flow arrows. Safe while tracing runs,
+	/// `start` waits for the export to finish, but spans recorded during the export may be missed.
+	[[nodiscard]] std::string to_chrome_json();
+
+	/// Records the time from construction to destruction as a complete event
+	class span {
+	public:
+		span(const char* name, std::uint64_t call_id) noexcept
+			: name_(name), call_id_(call_id), start_ns_(is_enabled() ? now_ns() : 0)
+		{
+		}
+
+		~span()
+		{
+			if (start_ns_ != 0)
+				record(name_, call_id_, start_ns_, now_ns());
+		}
+
+		span(const span&) = delete;
+		span& operator=(const span&) = delete;
+
+	private:
+		const char* name_;
+		std::uint64_t call_id_;
+		std::uint64_t start_ns_;
+	};
+}
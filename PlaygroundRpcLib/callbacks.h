@@ -1,12 +1,53 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 namespace playground
 {
 	using pass_and_get_string_t = char* (*)(const char* str);
 	using pass_and_get_string_out_t = void (*)(const char* str, char** out_str);
 
+	/// `out_data` is allocated by the callee with `CoTaskMemAlloc`, same as returned strings
+	using pass_and_get_bytes_t = void (*)(const std::uint8_t* data, std::size_t size, std::uint8_t** out_data, std::size_t* out_size);
+
+	/// A piece of a reply, either pointing into the request string or to handler-owned memory
+	struct reply_segment {
+		const char* data = nullptr;
+		std::size_t size = 0;
+	};
+
+	/// Describes the reply as up to `capacity` ordered segments and returns their count. The request
+	/// string stays valid until the segments are gathered. Handler-owned memory is released through
+	/// `release_reply` with the `context` the handler set.
+	using pass_and_get_string_gather_t = std::size_t (*)(const char* str, reply_segment* segments, std::size_t capacity, void** context);
+	using release_reply_t = void (*)(void* context);
+
+	/// One request of a batch, the string stays valid until the batch callback returns
+	struct batch_request {
+		const char* str = nullptr;
+		std::size_t size = 0;
+	};
+
+	/// Answers `count` requests in one call, one managed transition for the whole group. Sets
+	/// `replies[i]` to a `CoTaskMemAlloc` string, or leaves it null, for every request.
+	using pass_and_get_string_batch_t = void (*)(const batch_request* requests, char** replies, std::size_t count);
+
+	/// Handler of one method of `invoke`, registered at runtime in the `dispatch_registry`. `out_data` is
+	/// allocated by the callee with `CoTaskMemAlloc`. Returns 0 on success or a system error code.
+	using method_handler_t = std::uint32_t (*)(void* context, const std::uint8_t* data, std::size_t size, std::uint8_t** out_data, std::size_t* out_size);
+
 	struct callbacks {
 		pass_and_get_string_t pass_and_get_string = nullptr;
 		pass_and_get_string_out_t pass_and_get_string_out = nullptr;
+		pass_and_get_bytes_t pass_and_get_bytes = nullptr;
+
+		/// Takes precedence over `pass_and_get_string` when set
+		pass_and_get_string_gather_t pass_and_get_string_gather = nullptr;
+		release_reply_t release_reply = nullptr;
+
+		/// Takes precedence over `pass_and_get_string` when set, concurrent requests are grouped
+		/// into micro-batches, see `batch_dispatcher.h`
+		pass_and_get_string_batch_t pass_and_get_string_batch = nullptr;
 	};
 }
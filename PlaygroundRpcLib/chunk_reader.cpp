@@ -0,0 +1,305 @@
+#include "chunk_reader.h"
+
+#include <algorithm>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace playground
+{
+#ifdef _WIN32
+	struct chunk_reader::impl {
+		struct slot {
+			std::vector<std::byte> buffer;
+			OVERLAPPED overlapped{};
+			bool pending = false;
+		};
+
+		HANDLE file = INVALID_HANDLE_VALUE;
+		std::uint64_t size = 0;
+		std::uint64_t next_offset = 0;
+		std::vector<slot> slots;
+		size_t head = 0; // slot of the next chunk in file order
+		size_t in_flight = 0;
+		bool has_returned = false;
+
+		~impl()
+		{
+			if (file == INVALID_HANDLE_VALUE)
+				return;
+
+			std::ignore = CancelIoEx(file, nullptr);
+
+			for (auto& s : slots)
+			{
+				if (s.pending) {
+					DWORD transferred = 0;
+					std::ignore = GetOverlappedResult(file, &s.overlapped, &transferred, TRUE);
+				}
+
+				if (s.overlapped.hEvent != nullptr)
+					std::ignore = CloseHandle(s.overlapped.hEvent);
+			}
+
+			std::ignore = CloseHandle(file);
+		}
+
+		void issue(slot& s)
+		{
+			if (next_offset >= size)
+				return;
+
+			const auto length = static_cast<DWORD>(std::min<std::uint64_t>(s.buffer.size(), size - next_offset));
+
+			s.overlapped.Offset = static_cast<DWORD>(next_offset);
+			s.overlapped.OffsetHigh = static_cast<DWORD>(next_offset >> 32);
+
+			if (!ReadFile(file, s.buffer.data(), length, nullptr, &s.overlapped) && GetLastError() != ERROR_IO_PENDING)
+				throw std::system_error(GetLastError(), std::system_category(), "ReadFile failed");
+
+			s.pending = true;
+			++in_flight;
+			next_offset += length;
+		}
+	};
+
+	chunk_reader::chunk_reader(const char* path, chunk_reader_options options)
+		: impl_(std::make_unique<impl>())
+	{
+		impl_->file = CreateFileA(
+			path,
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN,
+			nullptr);
+
+		if (impl_->file == INVALID_HANDLE_VALUE)
+			throw std::system_error(GetLastError(), std::system_category(), "CreateFileA failed");
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(impl_->file, &file_size))
+			throw std::system_error(GetLastError(), std::system_category(), "GetFileSizeEx failed");
+
+		impl_->size = static_cast<std::uint64_t>(file_size.QuadPart);
+
+		// A single ReadFile transfers at most a DWORD worth of bytes
+		const size_t chunk_size = std::clamp<size_t>(options.chunk_size, 1, MAXDWORD);
+
+		impl_->slots.resize(std::max<size_t>(options.queue_depth, 2));
+		for (auto& s : impl_->slots)
+		{
+			s.buffer.resize(chunk_size);
+			s.overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+			if (s.overlapped.hEvent == nullptr)
+				throw std::system_error(GetLastError(), std::system_category(), "CreateEventW failed");
+		}
+
+		for (auto& s : impl_->slots)
+			impl_->issue(s);
+	}
+
+	std::span<const std::byte> chunk_reader::next()
+	{
+		auto& self = *impl_;
+		const size_t depth = self.slots.size();
+
+		// The previously returned buffer goes to the back of the queue
+		if (self.has_returned) {
+			self.has_returned = false;
+			self.issue(self.slots[(self.head + depth - 1) % depth]);
+		}
+
+		if (self.in_flight == 0)
+			return {};
+
+		auto& s = self.slots[self.head];
+
+		DWORD transferred = 0;
+		const bool ok = GetOverlappedResult(self.file, &s.overlapped, &transferred, TRUE);
+		s.pending = false;
+		--self.in_flight;
+
+		if (!ok)
+			throw std::system_error(GetLastError(), std::system_category(), "GetOverlappedResult failed");
+
+		self.head = (self.head + 1) % depth;
+		self.has_returned = true;
+
+		return { s.buffer.data(), transferred };
+	}
+#else
+	struct chunk_reader::impl {
+		struct ready_chunk {
+			size_t index = 0;
+			size_t size = 0;
+		};
+
+		int fd = -1;
+		std::uint64_t size = 0;
+		std::vector<std::vector<std::byte>> buffers;
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::deque<size_t> free;
+		std::deque<ready_chunk> ready;
+		bool done = false;
+		bool stop = false;
+		int error = 0;
+
+		bool has_returned = false;
+		size_t returned = 0;
+
+		std::thread worker;
+
+		~impl()
+		{
+			{
+				std::scoped_lock lock(mutex);
+				stop = true;
+			}
+			changed.notify_all();
+
+			if (worker.joinable())
+				worker.join();
+
+			if (fd >= 0)
+				std::ignore = ::close(fd);
+		}
+
+		void read_ahead()
+		{
+			std::uint64_t offset = 0;
+
+			while (offset < size)
+			{
+				size_t index = 0;
+				{
+					std::unique_lock lock(mutex);
+					changed.wait(lock, [&] { return stop || !free.empty(); });
+					if (stop)
+						return;
+
+					index = free.front();
+					free.pop_front();
+				}
+
+				auto& buffer = buffers[index];
+				const size_t length = static_cast<size_t>(std::min<std::uint64_t>(buffer.size(), size - offset));
+
+				size_t filled = 0;
+				int read_error = 0;
+				while (filled < length)
+				{
+					const auto n = ::pread(fd, buffer.data() + filled, length - filled, static_cast<off_t>(offset + filled));
+					if (n < 0 && errno == EINTR)
+						continue;
+
+					if (n < 0)
+						read_error = errno;
+
+					// The file shrank, stop at what is there
+					if (n <= 0)
+						break;
+
+					filled += static_cast<size_t>(n);
+				}
+
+				{
+					std::scoped_lock lock(mutex);
+					if (read_error != 0)
+						error = read_error;
+					else if (filled > 0)
+						ready.push_back({ index, filled });
+				}
+				changed.notify_all();
+
+				if (read_error != 0 || filled < length)
+					break;
+
+				offset += filled;
+			}
+
+			{
+				std::scoped_lock lock(mutex);
+				done = true;
+			}
+			changed.notify_all();
+		}
+	};
+
+	chunk_reader::chunk_reader(const char* path, chunk_reader_options options)
+		: impl_(std::make_unique<impl>())
+	{
+		impl_->fd = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (impl_->fd < 0)
+			throw std::system_error(errno, std::generic_category(), "open failed");
+
+		struct stat status {};
+		if (::fstat(impl_->fd, &status) != 0)
+			throw std::system_error(errno, std::generic_category(), "fstat failed");
+
+		impl_->size = static_cast<std::uint64_t>(status.st_size);
+
+		std::ignore = ::posix_fadvise(impl_->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+		impl_->buffers.resize(std::max<size_t>(options.queue_depth, 2));
+		for (size_t i = 0; i < impl_->buffers.size(); ++i)
+		{
+			impl_->buffers[i].resize(std::max<size_t>(options.chunk_size, 1));
+			impl_->free.push_back(i);
+		}
+
+		impl_->worker = std::thread([self = impl_.get()] { self->read_ahead(); });
+	}
+
+	std::span<const std::byte> chunk_reader::next()
+	{
+		auto& self = *impl_;
+		std::unique_lock lock(self.mutex);
+
+		if (self.has_returned) {
+			self.has_returned = false;
+			self.free.push_back(self.returned);
+			self.changed.notify_all();
+		}
+
+		self.changed.wait(lock, [&] { return !self.ready.empty() || self.done || self.error != 0; });
+
+		if (self.error != 0)
+			throw std::system_error(self.error, std::generic_category(), "pread failed");
+
+		if (self.ready.empty())
+			return {};
+
+		const auto chunk = self.ready.front();
+		self.ready.pop_front();
+
+		self.has_returned = true;
+		self.returned = chunk.index;
+
+		return { self.buffers[chunk.index].data(), chunk.size };
+	}
+#endif
+
+	chunk_reader::~chunk_reader() = default;
+
+	std::uint64_t chunk_reader::file_size() const noexcept
+	{
+		return impl_->size;
+	}
+}
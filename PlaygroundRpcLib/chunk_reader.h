@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace playground
+{
+	struct chunk_reader_options {
+		size_t chunk_size = 1024 * 1024;
+
+		/// Number of chunk buffers, at least 2 so the next chunk is read while the current one is consumed
+		size_t queue_depth = 4;
+	};
+
+	/// Reads a file front to back in chunks, keeping up to `queue_depth - 1` reads in flight ahead of
+	/// the consumer. Overlapped I/O on Windows, a `pread` worker thread elsewhere.
+	class chunk_reader {
+	public:
+		/// Throws `std::system_error` when the file cannot be opened
+		chunk_reader(const char* path, chunk_reader_options options);
+		~chunk_reader();
+
+		chunk_reader(const chunk_reader&) = delete;
+		chunk_reader& operator=(const chunk_reader&) = delete;
+
+		/// Returns the next chunk, or an empty span at the end of the file. The chunk stays valid
+		/// until the next call, which hands its buffer back for reading ahead.
+		/// Throws `std::system_error` when a read fails.
+		[[nodiscard]] std::span<const std::byte> next();
+
+		[[nodiscard]] std::uint64_t file_size() const noexcept;
+
+	private:
+		struct impl;
+		std::unique_ptr<impl> impl_;
+	};
+}
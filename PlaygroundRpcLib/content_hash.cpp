@@ -0,0 +1,32 @@
+#include "content_hash.h"
+
+#include <limits>
+#include <system_error>
+#include <Windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+
+namespace playground
+{
+	content_hash hash_content(std::string_view content)
+	{
+		if (content.size() > std::numeric_limits<ULONG>::max())
+			throw std::system_error(ERROR_BUFFER_OVERFLOW, std::system_category(), "hash_content input is too large");
+
+		content_hash hash{};
+		if (auto status = BCryptHash(
+			BCRYPT_SHA256_ALG_HANDLE,
+			nullptr /* secret */,
+			0,
+			reinterpret_cast<PUCHAR>(const_cast<char*>(content.data())),
+			static_cast<ULONG>(content.size()),
+			hash.data(),
+			static_cast<ULONG>(hash.size())); !BCRYPT_SUCCESS(status))
+		{
+			throw std::system_error(status, std::system_category(), "BCryptHash failed");
+		}
+
+		return hash;
+	}
+}
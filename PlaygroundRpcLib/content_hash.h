@@ -0,0 +1,25 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace playground
+{
+	/// SHA-256 digest identifying a payload in the content store
+	using content_hash = std::array<std::uint8_t, 32>;
+
+	[[nodiscard]] content_hash hash_content(std::string_view content);
+
+	struct content_hash_hasher {
+		/// The digest is already uniformly distributed, any 8 bytes of it are a good bucket hash
+		[[nodiscard]] size_t operator()(const content_hash& hash) const noexcept
+		{
+			size_t value;
+			std::memcpy(&value, hash.data(), sizeof(value));
+			return value;
+		}
+	};
+}
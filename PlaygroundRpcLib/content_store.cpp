@@ -0,0 +1,66 @@
+#include "content_store.h"
+
+namespace playground
+{
+	std::shared_ptr<const std::string> content_store::find(const content_hash& hash)
+	{
+		std::scoped_lock lock(mutex_);
+
+		auto it = index_.find(hash);
+		if (it == index_.end()) {
+			++stats_.misses;
+			return nullptr;
+		}
+
+		++stats_.hits;
+		lru_.splice(lru_.begin(), lru_, it->second);
+		return it->second->content;
+	}
+
+	void content_store::insert(const content_hash& hash, std::shared_ptr<const std::string> content)
+	{
+		const size_t size = content->size();
+
+		std::scoped_lock lock(mutex_);
+
+		if (size > budget_ || index_.contains(hash))
+			return;
+
+		evict_to(budget_ - size);
+
+		lru_.push_front({ hash, std::move(content) });
+		index_.emplace(hash, lru_.begin());
+		bytes_ += size;
+	}
+
+	void content_store::set_budget(size_t budget_bytes)
+	{
+		std::scoped_lock lock(mutex_);
+
+		budget_ = budget_bytes;
+		evict_to(budget_);
+	}
+
+	content_store_stats content_store::stats() const
+	{
+		std::scoped_lock lock(mutex_);
+
+		auto stats = stats_;
+		stats.entries = index_.size();
+		stats.bytes = bytes_;
+		stats.budget = budget_;
+		return stats;
+	}
+
+	void content_store::evict_to(size_t budget_bytes)
+	{
+		while (bytes_ > budget_bytes && !lru_.empty())
+		{
+			const auto& victim = lru_.back();
+			bytes_ -= victim.content->size();
+			index_.erase(victim.hash);
+			lru_.pop_back();
+			++stats_.evictions;
+		}
+	}
+}
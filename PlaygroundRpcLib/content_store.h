@@ -0,0 +1,53 @@
+#pragma once
+
+#include "content_hash.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace playground
+{
+	struct content_store_stats {
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t evictions = 0;
+		std::uint64_t entries = 0;
+		std::uint64_t bytes = 0;
+		std::uint64_t budget = 0;
+	};
+
+	/// Bounded, thread-safe store of payloads keyed by their content hash, evicting least recently used entries
+	class content_store {
+	public:
+		explicit content_store(size_t budget_bytes) : budget_(budget_bytes) {}
+
+		/// Returns the stored content, or null on a miss
+		[[nodiscard]] std::shared_ptr<const std::string> find(const content_hash& hash);
+
+		/// Stores the content, content larger than the whole budget is not stored
+		void insert(const content_hash& hash, std::shared_ptr<const std::string> content);
+
+		void set_budget(size_t budget_bytes);
+
+		[[nodiscard]] content_store_stats stats() const;
+
+	private:
+		struct entry {
+			content_hash hash;
+			std::shared_ptr<const std::string> content;
+		};
+
+		void evict_to(size_t budget_bytes);
+
+		mutable std::mutex mutex_;
+		std::list<entry> lru_; // most recently used first
+		std::unordered_map<content_hash, std::list<entry>::iterator, content_hash_hasher> index_;
+		size_t budget_ = 0;
+		size_t bytes_ = 0;
+		content_store_stats stats_;
+	};
+}
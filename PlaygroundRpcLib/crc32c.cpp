@@ -0,0 +1,121 @@
+#include "crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PLAYGROUND_CRC32C_SSE42
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+	/// Reflected Castagnoli polynomial
+	constexpr std::uint32_t POLYNOMIAL = 0x82F63B78;
+
+	constexpr auto TABLE = [] {
+		std::array<std::uint32_t, 256> table{};
+		for (std::uint32_t i = 0; i < table.size(); ++i)
+		{
+			std::uint32_t crc = i;
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+			table[i] = crc;
+		}
+		return table;
+	}();
+
+	/// Table driven fallback, `destination` may be null for checksum only
+	[[nodiscard]] std::uint32_t update_software(std::uint32_t crc, char* destination, const char* source, size_t size) noexcept
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			const auto byte = static_cast<unsigned char>(source[i]);
+			crc = TABLE[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+			if (destination != nullptr)
+				destination[i] = static_cast<char>(byte);
+		}
+		return crc;
+	}
+
+#ifdef PLAYGROUND_CRC32C_SSE42
+	[[nodiscard]] bool has_sse42() noexcept
+	{
+#ifdef _MSC_VER
+		int info[4]{};
+		__cpuid(info, 1);
+		return (info[2] & (1 << 20)) != 0;
+#else
+		unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) != 0;
+#endif
+	}
+
+	/// One 8 byte load feeds both the store and the checksum
+#ifndef _MSC_VER
+	__attribute__((target("sse4.2")))
+#endif
+	[[nodiscard]] std::uint32_t update_sse42(std::uint32_t crc, char* destination, const char* source, size_t size) noexcept
+	{
+		std::uint64_t crc64 = crc;
+
+		for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t))
+		{
+			std::uint64_t word;
+			std::memcpy(&word, source, sizeof(word));
+			crc64 = _mm_crc32_u64(crc64, word);
+
+			if (destination != nullptr) {
+				std::memcpy(destination, &word, sizeof(word));
+				destination += sizeof(word);
+			}
+			source += sizeof(word);
+		}
+
+		crc = static_cast<std::uint32_t>(crc64);
+		for (; size > 0; --size)
+		{
+			crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*source));
+			if (destination != nullptr)
+				*destination++ = *source;
+			++source;
+		}
+
+		return crc;
+	}
+#endif
+
+	[[nodiscard]] std::uint32_t update(char* destination, const char* source, size_t size) noexcept
+	{
+		std::uint32_t crc = 0xFFFFFFFF;
+
+#ifdef PLAYGROUND_CRC32C_SSE42
+		static const bool hardware = has_sse42();
+		crc = hardware
+			? update_sse42(crc, destination, source, size)
+			: update_software(crc, destination, source, size);
+#else
+		crc = update_software(crc, destination, source, size);
+#endif
+
+		return ~crc;
+	}
+}
+
+namespace playground
+{
+	std::uint32_t crc32c(std::string_view data) noexcept
+	{
+		return update(nullptr, data.data(), data.size());
+	}
+
+	std::uint32_t copy_crc32c(char* destination, const char* source, size_t size) noexcept
+	{
+		return update(destination, source, size);
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace playground
+{
+	/// CRC-32C (Castagnoli), the checksum used by iSCSI, ext4 and SSE4.2's `crc32` instruction.
+	/// Computed with the hardware instruction when the CPU has it, with a table otherwise.
+	[[nodiscard]] std::uint32_t crc32c(std::string_view data) noexcept;
+
+	/// Copies `size` bytes from `source` to `destination` and returns the CRC-32C of them, reading
+	/// every byte once so the checksum costs no extra pass over memory
+	[[nodiscard]] std::uint32_t copy_crc32c(char* destination, const char* source, size_t size) noexcept;
+}
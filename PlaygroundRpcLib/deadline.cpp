@@ -0,0 +1,205 @@
+#include "deadline.h"
+
+#include "leaked_singleton.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <Windows.h>
+
+namespace
+{
+	std::array<std::atomic<std::uint64_t>, 4> counters;
+
+	/// Thread handle RpcCancelThreadEx takes, duplicated once per thread
+	class current_thread {
+	public:
+		current_thread()
+		{
+			std::ignore = DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &handle_, 0, FALSE, DUPLICATE_SAME_ACCESS);
+		}
+
+		~current_thread()
+		{
+			if (handle_ != nullptr)
+				std::ignore = CloseHandle(handle_);
+		}
+
+		[[nodiscard]] HANDLE get() const noexcept { return handle_; }
+
+	private:
+		HANDLE handle_ = nullptr;
+	};
+
+	thread_local current_thread this_thread;
+
+	struct server_call {
+		std::uint64_t deadline_ns = 0;
+		bool reported = false;
+	};
+
+	thread_local server_call current_server_call;
+
+	[[nodiscard]] playground::deadline::clock::time_point from_ns(std::uint64_t deadline_ns) noexcept
+	{
+		return playground::deadline::clock::time_point{ std::chrono::duration_cast<playground::deadline::clock::duration>(std::chrono::nanoseconds{ deadline_ns }) };
+	}
+}
+
+namespace playground::deadline
+{
+	class watchdog {
+	public:
+		watchdog()
+			: thread_([this] { run(); })
+		{
+		}
+
+		void add(cancel_scope& scope)
+		{
+			bool earliest = false;
+			{
+				std::scoped_lock lock(mutex_);
+				const auto it = scopes_.emplace(scope.deadline_ns_, &scope).first;
+				earliest = it == scopes_.begin();
+			}
+
+			if (earliest)
+				wake_.notify_one();
+		}
+
+		void remove(cancel_scope& scope) noexcept
+		{
+			std::scoped_lock lock(mutex_);
+			scopes_.erase({ scope.deadline_ns_, &scope });
+		}
+
+	private:
+		void run()
+		{
+			std::unique_lock lock(mutex_);
+			while (true)
+			{
+				if (scopes_.empty()) {
+					wake_.wait(lock);
+					continue;
+				}
+
+				const auto [deadline_ns, scope] = *scopes_.begin();
+				if (!has_passed(deadline_ns)) {
+					wake_.wait_until(lock, from_ns(deadline_ns));
+					continue;
+				}
+
+				// Under the lock, so the scope cannot end and its thread move on to another call
+				scopes_.erase(scopes_.begin());
+				scope->cancelled_.store(RpcCancelThreadEx(scope->thread_, 0) == RPC_S_OK, std::memory_order_release);
+			}
+		}
+
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		std::set<std::pair<std::uint64_t, cancel_scope*>> scopes_;
+		std::jthread thread_;
+	};
+
+	[[nodiscard]] static watchdog& get_watchdog()
+	{
+		return leaked_singleton<watchdog>();
+	}
+
+	std::uint64_t to_ns(clock::time_point deadline) noexcept
+	{
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count());
+	}
+
+	bool has_passed(std::uint64_t deadline_ns) noexcept
+	{
+		return deadline_ns != 0 && to_ns(clock::now()) >= deadline_ns;
+	}
+
+	void count(counter counter) noexcept
+	{
+		counters[static_cast<size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	deadline_stats get_stats() noexcept
+	{
+		return {
+			.client_expired = counters[static_cast<size_t>(counter::client_expired)].load(std::memory_order_relaxed),
+			.client_cancelled = counters[static_cast<size_t>(counter::client_cancelled)].load(std::memory_order_relaxed),
+			.server_skipped = counters[static_cast<size_t>(counter::server_skipped)].load(std::memory_order_relaxed),
+			.server_cancelled = counters[static_cast<size_t>(counter::server_cancelled)].load(std::memory_order_relaxed),
+		};
+	}
+
+	cancel_scope::cancel_scope(std::uint64_t deadline_ns)
+		: deadline_ns_(deadline_ns), thread_(this_thread.get())
+	{
+		get_watchdog().add(*this);
+	}
+
+	cancel_scope::~cancel_scope()
+	{
+		get_watchdog().remove(*this);
+	}
+
+	bool call_canceller::arm() noexcept
+	{
+		std::scoped_lock lock(mutex_);
+		thread_ = this_thread.get();
+		return !cancelled_;
+	}
+
+	void call_canceller::disarm() noexcept
+	{
+		std::scoped_lock lock(mutex_);
+		thread_ = nullptr;
+	}
+
+	void call_canceller::cancel() noexcept
+	{
+		// Under the lock, so the armed thread cannot move on to another call meanwhile
+		std::scoped_lock lock(mutex_);
+		cancelled_ = true;
+
+		if (thread_ != nullptr)
+			std::ignore = RpcCancelThreadEx(thread_, 0);
+	}
+
+	bool call_canceller::cancelled() const noexcept
+	{
+		std::scoped_lock lock(mutex_);
+		return cancelled_;
+	}
+
+	server_scope::server_scope(std::uint64_t deadline_ns) noexcept
+		: outer_deadline_ns_(current_server_call.deadline_ns), outer_reported_(current_server_call.reported)
+	{
+		current_server_call = { .deadline_ns = deadline_ns };
+	}
+
+	server_scope::~server_scope()
+	{
+		current_server_call = { .deadline_ns = outer_deadline_ns_, .reported = outer_reported_ };
+	}
+
+	bool server_call_cancelled() noexcept
+	{
+		// RpcTestCancel fails outside of a dispatched RPC call, e.g. on the in-process path
+		const bool cancelled = has_passed(current_server_call.deadline_ns) || RpcTestCancel() == RPC_S_OK;
+
+		// Handlers poll, every cancelled call is counted once
+		if (cancelled && !current_server_call.reported) {
+			current_server_call.reported = true;
+			count(counter::server_cancelled);
+		}
+
+		return cancelled;
+	}
+}
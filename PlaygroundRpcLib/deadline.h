@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+/// Per-call deadlines. A deadline travels in the `deadline_context` as nanoseconds of the steady
+/// clock, which both ends share since ncalrpc only connects processes of one machine.
+namespace playground::deadline
+{
+	using clock = std::chrono::steady_clock;
+
+	/// 0 stands for no deadline
+	[[nodiscard]] std::uint64_t to_ns(clock::time_point deadline) noexcept;
+	[[nodiscard]] bool has_passed(std::uint64_t deadline_ns) noexcept;
+
+	struct deadline_stats {
+		/// Client calls which failed with ERROR_TIMEOUT
+		std::uint64_t client_expired = 0;
+
+		/// Of those, calls cancelled while waiting for the server
+		std::uint64_t client_cancelled = 0;
+
+		/// Calls the server did not dispatch because they had expired on arrival
+		std::uint64_t server_skipped = 0;
+
+		/// Calls a handler found cancelled through `server::is_call_cancelled`
+		std::uint64_t server_cancelled = 0;
+	};
+
+	enum class counter {
+		client_expired,
+		client_cancelled,
+		server_skipped,
+		server_cancelled,
+	};
+
+	void count(counter counter) noexcept;
+	[[nodiscard]] deadline_stats get_stats() noexcept;
+
+	/// Cancels the RPC call this thread makes within the scope once `deadline_ns` passes, the call
+	/// then fails with RPC_S_CALL_CANCELLED. A single watchdog thread serves all scopes.
+	class cancel_scope {
+	public:
+		explicit cancel_scope(std::uint64_t deadline_ns);
+		~cancel_scope();
+
+		cancel_scope(const cancel_scope&) = delete;
+		cancel_scope& operator=(const cancel_scope&) = delete;
+
+		[[nodiscard]] bool cancelled() const noexcept { return cancelled_.load(std::memory_order_acquire); }
+
+	private:
+		friend class watchdog;
+
+		std::uint64_t deadline_ns_ = 0;
+		void* thread_ = nullptr;
+
+		/// Set by the watchdog thread
+		std::atomic<bool> cancelled_{ false };
+	};
+
+	/// Lets any thread cancel the RPC call the arming thread makes until it disarms, e.g. the losing
+	/// attempt of a hedged call. A cancel before `arm` sticks, the call is then not to be made.
+	class call_canceller {
+	public:
+		/// False when already cancelled
+		[[nodiscard]] bool arm() noexcept;
+		void disarm() noexcept;
+
+		void cancel() noexcept;
+		[[nodiscard]] bool cancelled() const noexcept;
+
+	private:
+		mutable std::mutex mutex_;
+		void* thread_ = nullptr;
+		bool cancelled_ = false;
+	};
+
+	/// Deadline of the call the server dispatches on this thread, restores the outer one on exit,
+	/// which matters for calls taking the in-process path
+	class server_scope {
+	public:
+		explicit server_scope(std::uint64_t deadline_ns) noexcept;
+		~server_scope();
+
+		server_scope(const server_scope&) = delete;
+		server_scope& operator=(const server_scope&) = delete;
+
+	private:
+		std::uint64_t outer_deadline_ns_ = 0;
+		bool outer_reported_ = false;
+	};
+
+	/// Whether the call dispatched on this thread passed its deadline or the client cancelled it
+	[[nodiscard]] bool server_call_cancelled() noexcept;
+}
@@ -0,0 +1,181 @@
+#include "delta_codec.h"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+	constexpr std::byte OP_COPY{ 0x01 };
+	constexpr std::byte OP_INSERT{ 0x02 };
+
+	constexpr std::uint32_t HASH_BASE = 0x01000193;
+
+	/// HASH_BASE^(BLOCK_SIZE - 1), the weight of the byte leaving the window
+	constexpr std::uint32_t HASH_OUT_WEIGHT = [] {
+		std::uint32_t weight = 1;
+		for (size_t i = 1; i < playground::delta::BLOCK_SIZE; ++i)
+			weight *= HASH_BASE;
+		return weight;
+	}();
+
+	[[nodiscard]] std::uint32_t hash_block(const char* data) noexcept
+	{
+		std::uint32_t hash = 0;
+		for (size_t i = 0; i < playground::delta::BLOCK_SIZE; ++i)
+			hash = hash * HASH_BASE + static_cast<unsigned char>(data[i]);
+		return hash;
+	}
+
+	[[nodiscard]] std::uint32_t roll(std::uint32_t hash, char out, char in) noexcept
+	{
+		return (hash - static_cast<unsigned char>(out) * HASH_OUT_WEIGHT) * HASH_BASE + static_cast<unsigned char>(in);
+	}
+
+	void put_varint(std::vector<std::byte>& out, size_t value)
+	{
+		while (value >= 0x80) {
+			out.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<std::byte>(value));
+	}
+
+	[[nodiscard]] bool get_varint(std::span<const std::byte>& in, size_t& value) noexcept
+	{
+		value = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7)
+		{
+			if (in.empty())
+				return false;
+
+			const auto byte = std::to_integer<size_t>(in.front());
+			in = in.subspan(1);
+
+			value |= (byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	void put_insert(std::vector<std::byte>& out, std::string_view literal)
+	{
+		if (literal.empty())
+			return;
+
+		out.push_back(OP_INSERT);
+		put_varint(out, literal.size());
+
+		const auto* first = reinterpret_cast<const std::byte*>(literal.data());
+		out.insert(out.end(), first, first + literal.size());
+	}
+
+	void put_copy(std::vector<std::byte>& out, size_t offset, size_t length)
+	{
+		out.push_back(OP_COPY);
+		put_varint(out, offset);
+		put_varint(out, length);
+	}
+}
+
+namespace playground::delta
+{
+	std::vector<std::byte> encode(std::string_view base, std::string_view target)
+	{
+		if (base.size() < BLOCK_SIZE || target.size() < BLOCK_SIZE)
+			return encode_full(target);
+
+		std::unordered_map<std::uint32_t, size_t> blocks;
+		blocks.reserve(base.size() / BLOCK_SIZE);
+		for (size_t offset = 0; offset + BLOCK_SIZE <= base.size(); offset += BLOCK_SIZE)
+			blocks.emplace(hash_block(base.data() + offset), offset);
+
+		std::vector<std::byte> out;
+		size_t literal_start = 0;
+		size_t i = 0;
+		std::uint32_t hash = hash_block(target.data());
+
+		while (i + BLOCK_SIZE <= target.size())
+		{
+			auto it = blocks.find(hash);
+			if (it != blocks.end() && std::memcmp(base.data() + it->second, target.data() + i, BLOCK_SIZE) == 0)
+			{
+				size_t offset = it->second;
+
+				// Grow the match backwards into the pending literal and forwards past the block
+				while (i > literal_start && offset > 0 && target[i - 1] == base[offset - 1]) {
+					--i;
+					--offset;
+				}
+
+				size_t length = BLOCK_SIZE + (it->second - offset);
+				while (i + length < target.size() && offset + length < base.size() && target[i + length] == base[offset + length])
+					++length;
+
+				put_insert(out, target.substr(literal_start, i - literal_start));
+				put_copy(out, offset, length);
+
+				i += length;
+				literal_start = i;
+
+				if (i + BLOCK_SIZE <= target.size())
+					hash = hash_block(target.data() + i);
+				continue;
+			}
+
+			if (i + BLOCK_SIZE >= target.size())
+				break;
+
+			hash = roll(hash, target[i], target[i + BLOCK_SIZE]);
+			++i;
+		}
+
+		put_insert(out, target.substr(literal_start));
+		return out;
+	}
+
+	std::vector<std::byte> encode_full(std::string_view target)
+	{
+		std::vector<std::byte> out;
+		out.reserve(target.size() + 11);
+		put_insert(out, target);
+		return out;
+	}
+
+	std::optional<std::string> apply(std::string_view base, std::span<const std::byte> delta)
+	{
+		std::string target;
+
+		while (!delta.empty())
+		{
+			const auto op = delta.front();
+			delta = delta.subspan(1);
+
+			if (op == OP_COPY) {
+				size_t offset = 0;
+				size_t length = 0;
+				if (!get_varint(delta, offset) || !get_varint(delta, length))
+					return std::nullopt;
+
+				if (offset > base.size() || length > base.size() - offset)
+					return std::nullopt;
+
+				target.append(base.substr(offset, length));
+			}
+			else if (op == OP_INSERT) {
+				size_t length = 0;
+				if (!get_varint(delta, length) || length > delta.size())
+					return std::nullopt;
+
+				target.append(reinterpret_cast<const char*>(delta.data()), length);
+				delta = delta.subspan(length);
+			}
+			else {
+				return std::nullopt;
+			}
+		}
+
+		return target;
+	}
+}
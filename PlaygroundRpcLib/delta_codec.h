@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Binary delta of a payload against the previous payload of the same session.
+///
+/// A delta is a sequence of operations:
+///   COPY   { u8 0x01, varint offset, varint length }  copies a range of the base
+///   INSERT { u8 0x02, varint length, bytes }          appends literal bytes
+///
+/// Matches are found by indexing the base in fixed blocks with a rolling hash and
+/// sliding the same hash over the target, then extending every verified match.
+namespace playground::delta
+{
+	constexpr size_t BLOCK_SIZE = 16;
+
+	[[nodiscard]] std::vector<std::byte> encode(std::string_view base, std::string_view target);
+
+	/// Returns an insert-only delta, used when there is no base to diff against
+	[[nodiscard]] std::vector<std::byte> encode_full(std::string_view target);
+
+	/// Rebuilds the target, or returns nothing when the delta is malformed or does not fit the base
+	[[nodiscard]] std::optional<std::string> apply(std::string_view base, std::span<const std::byte> delta);
+}
@@ -0,0 +1,53 @@
+#include "delta_sessions.h"
+#include "delta_codec.h"
+
+namespace playground
+{
+	std::optional<std::string> delta_session_store::apply(std::uint64_t session_id, std::uint32_t base_version, std::span<const std::byte> delta)
+	{
+		std::unique_lock lock(mutex_);
+
+		auto it = index_.find(session_id);
+		if (it == index_.end()) {
+			if (base_version != 0)
+				return std::nullopt;
+
+			if (lru_.size() >= max_sessions_ && !lru_.empty()) {
+				index_.erase(lru_.back().id);
+				lru_.pop_back();
+			}
+
+			lru_.push_front({ .id = session_id, .version = 0, .payload = {} });
+			it = index_.emplace(session_id, lru_.begin()).first;
+		}
+		else {
+			lru_.splice(lru_.begin(), lru_, it->second);
+		}
+
+		auto& current = *it->second;
+		if (base_version != 0 && base_version != current.version)
+			return std::nullopt;
+
+		// Calls of one session are sequential, only the bookkeeping needs the lock
+		std::string base = base_version == 0 ? std::string{} : std::move(current.payload);
+		lock.unlock();
+
+		auto payload = delta::apply(base, delta);
+
+		lock.lock();
+		it = index_.find(session_id);
+		if (it == index_.end())
+			return payload;
+
+		if (payload) {
+			it->second->payload = *payload;
+			it->second->version = next_delta_version(base_version);
+		}
+		else {
+			it->second->payload.clear();
+			it->second->version = 0;
+		}
+
+		return payload;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+namespace playground
+{
+	/// Server-side last payload of each delta session, the least recently used sessions are dropped
+	class delta_session_store {
+	public:
+		explicit delta_session_store(size_t max_sessions) : max_sessions_(max_sessions) {}
+
+		/// Rebuilds the payload from a delta against version `base_version` of the session and stores
+		/// it as the next version. Version 0 has an empty base. Returns nothing on a version mismatch,
+		/// e.g. after the session was dropped, and the client has to resend the full payload.
+		[[nodiscard]] std::optional<std::string> apply(std::uint64_t session_id, std::uint32_t base_version, std::span<const std::byte> delta);
+
+	private:
+		struct session {
+			std::uint64_t id = 0;
+			std::uint32_t version = 0;
+			std::string payload;
+		};
+
+		std::mutex mutex_;
+		std::list<session> lru_; // most recently used first
+		std::unordered_map<std::uint64_t, std::list<session>::iterator> index_;
+		size_t max_sessions_ = 0;
+	};
+
+	/// Versions are never 0 once a payload is stored
+	[[nodiscard]] constexpr std::uint32_t next_delta_version(std::uint32_t version) noexcept
+	{
+		return version + 1 == 0 ? 1 : version + 1;
+	}
+}
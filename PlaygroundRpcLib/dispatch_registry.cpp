@@ -0,0 +1,92 @@
+#include "dispatch_registry.h"
+
+#include "../Common/defer.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+constexpr std::uint32_t ERROR_CALL_NOT_IMPLEMENTED = 120;
+#endif
+
+namespace playground
+{
+	namespace
+	{
+		/// The `invoke` calls running on this thread, innermost first, so a handler which unregisters
+		/// itself does not wait for its own call
+		struct call_frame {
+			const void* entry;
+			const call_frame* outer;
+		};
+
+		thread_local const call_frame* innermost_call = nullptr;
+
+		[[nodiscard]] std::uint32_t calls_on_this_thread(const void* entry) noexcept
+		{
+			std::uint32_t count = 0;
+			for (auto* frame = innermost_call; frame != nullptr; frame = frame->outer)
+				count += frame->entry == entry;
+			return count;
+		}
+	}
+
+	bool dispatch_registry::register_method(std::uint32_t method_id, handler h)
+	{
+		if (method_id >= MAX_METHODS || h.fn == nullptr)
+			return false;
+
+		auto replacement = std::make_shared<entry>();
+		replacement->h = h;
+
+		wait_for_calls(slots_[method_id].exchange(std::move(replacement)));
+		return true;
+	}
+
+	bool dispatch_registry::unregister_method(std::uint32_t method_id)
+	{
+		if (method_id >= MAX_METHODS)
+			return false;
+
+		const auto old = slots_[method_id].exchange(nullptr);
+
+		wait_for_calls(old);
+		return old != nullptr;
+	}
+
+	std::uint32_t dispatch_registry::invoke(std::uint32_t method_id, const std::uint8_t* data, std::size_t size, std::uint8_t** out_data, std::size_t* out_size) const
+	{
+		if (method_id >= MAX_METHODS)
+			return ERROR_CALL_NOT_IMPLEMENTED;
+
+		// The copy only keeps the counters alive, the count is what `wait_for_calls` waits on
+		for (auto e = slots_[method_id].load(); e != nullptr; e = slots_[method_id].load()) {
+			e->calls.fetch_add(1);
+			defer(e->calls.fetch_sub(1); if (e->retired.load()) e->calls.notify_all());
+
+			// Counted before checking `retired`, and `wait_for_calls` sets it before reading the
+			// count, so either this call backs off to the new handler or the waiter sees it
+			if (e->retired.load())
+				continue;
+
+			const call_frame frame{ e.get(), innermost_call };
+			innermost_call = &frame;
+			defer(innermost_call = frame.outer);
+
+			return e->h.fn(e->h.context, data, size, out_data, out_size);
+		}
+
+		return ERROR_CALL_NOT_IMPLEMENTED;
+	}
+
+	void dispatch_registry::wait_for_calls(const std::shared_ptr<entry>& old)
+	{
+		if (old == nullptr)
+			return;
+
+		old->retired.store(true);
+
+		const auto own = calls_on_this_thread(old.get());
+		for (auto calls = old->calls.load(); calls > own; calls = old->calls.load())
+			old->calls.wait(calls);
+	}
+}
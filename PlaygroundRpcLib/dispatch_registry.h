@@ -0,0 +1,52 @@
+#pragma once
+
+#include "callbacks.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace playground
+{
+	/// Method handlers of the generic `invoke` entry point, indexed by method id. Lookup is a single
+	/// array access, so adding an operation needs neither an IDL change nor a verb prefix to parse.
+	class dispatch_registry {
+	public:
+		/// Ids are dense table indices, not hashes
+		static constexpr std::uint32_t MAX_METHODS = 1024;
+
+		struct handler {
+			method_handler_t fn = nullptr;
+			void* context = nullptr;
+		};
+
+		/// Replaces any handler of the id. Returns false for an id out of range or a null handler.
+		bool register_method(std::uint32_t method_id, handler h);
+
+		/// Returns false when nothing was registered. Both this and replacing a handler wait for the
+		/// calls already running the old one, so its code and context may be released afterwards.
+		/// Called from inside that handler, it waits for the other calls only: the calling handler
+		/// is still running then and must not release its own code or context.
+		bool unregister_method(std::uint32_t method_id);
+
+		/// Returns ERROR_CALL_NOT_IMPLEMENTED when no handler is registered for the id
+		[[nodiscard]] std::uint32_t invoke(std::uint32_t method_id, const std::uint8_t* data, std::size_t size, std::uint8_t** out_data, std::size_t* out_size) const;
+
+	private:
+		struct entry {
+			handler h;
+
+			/// Calls running `h`, signalled on every exit once the entry is retired
+			std::atomic<std::uint32_t> calls{ 0 };
+			std::atomic<bool> retired{ false };
+		};
+
+		using slot = std::atomic<std::shared_ptr<entry>>;
+
+		static void wait_for_calls(const std::shared_ptr<entry>& old);
+
+		std::array<slot, MAX_METHODS> slots_{};
+	};
+}
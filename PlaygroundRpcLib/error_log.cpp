@@ -0,0 +1,92 @@
+#include "error_log.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <print>
+
+namespace
+{
+	std::atomic<std::uint32_t> rate{ playground::error_log::DEFAULT_MESSAGES_PER_SECOND };
+	std::atomic<std::uint64_t> suppressed_total;
+
+	/// Dropped since the last printed message
+	std::atomic<std::uint64_t> suppressed_pending;
+
+	/// Guards the window and the console, never waited for
+	std::mutex print_mutex;
+	std::chrono::steady_clock::time_point window_start;
+	std::uint32_t printed_in_window = 0;
+
+	void suppress() noexcept
+	{
+		suppressed_total.fetch_add(1, std::memory_order_relaxed);
+		suppressed_pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/// Calls `print` with the number of messages dropped before this one, within the budget only
+	template <class Print>
+	void report_limited(Print&& print) noexcept
+	{
+		std::unique_lock lock(print_mutex, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			suppress();
+			return;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - window_start >= std::chrono::seconds(1)) {
+			window_start = now;
+			printed_in_window = 0;
+		}
+
+		if (printed_in_window >= rate.load(std::memory_order_relaxed)) {
+			suppress();
+			return;
+		}
+
+		++printed_in_window;
+
+		try {
+			print(suppressed_pending.exchange(0, std::memory_order_relaxed));
+		}
+		catch (const std::exception&) {
+			// Nowhere left to report a failing console
+		}
+	}
+}
+
+namespace playground::error_log
+{
+	void report(std::string_view message) noexcept
+	{
+		report_limited([&](std::uint64_t skipped) {
+			if (skipped == 0)
+				std::println("Error: {}", message);
+			else
+				std::println("Error: {} ({} more errors suppressed)", message, skipped);
+		});
+	}
+
+	void report(const rpc_error& error) noexcept
+	{
+		report_limited([&](std::uint64_t skipped) {
+			const auto text = std::system_category().message(static_cast<int>(error.status));
+			if (skipped == 0)
+				std::println("Error: {} failed: {}", error.operation, text);
+			else
+				std::println("Error: {} failed: {} ({} more errors suppressed)", error.operation, text, skipped);
+		});
+	}
+
+	void set_rate(std::uint32_t messages_per_second) noexcept
+	{
+		rate.store(messages_per_second, std::memory_order_relaxed);
+	}
+
+	std::uint64_t suppressed() noexcept
+	{
+		return suppressed_total.load(std::memory_order_relaxed);
+	}
+}
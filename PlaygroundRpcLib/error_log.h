@@ -0,0 +1,26 @@
+#pragma once
+
+#include "rpc_error.h"
+
+#include <cstdint>
+#include <string_view>
+
+/// Rate-limited error output. A burst of failures costs a counter increment per failure instead of
+/// a console write, so logging does not make an overload worse.
+namespace playground::error_log
+{
+	constexpr std::uint32_t DEFAULT_MESSAGES_PER_SECOND = 10;
+
+	/// Prints "Error: <message>" unless this second's budget is spent or another thread is printing,
+	/// in which case the message is only counted. The count is printed with the next message.
+	void report(std::string_view message) noexcept;
+
+	/// Formats the status text only when the message gets printed
+	void report(const rpc_error& error) noexcept;
+
+	/// 0 silences the output, failures are still counted
+	void set_rate(std::uint32_t messages_per_second) noexcept;
+
+	/// Messages dropped since the process started
+	[[nodiscard]] std::uint64_t suppressed() noexcept;
+}
@@ -0,0 +1,185 @@
+#include "file_cache.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	/// Canonical path, so `a/../b`, `./b` and a symlink to `b` share an entry. Windows paths are
+	/// case-insensitive, so they are also folded to lower case.
+	[[nodiscard]] std::string cache_key(const char* path)
+	{
+		// Resolves the existing part of the path, falls back to a lexical form when that fails
+		std::error_code error;
+		auto canonical = std::filesystem::weakly_canonical(path, error);
+		if (error)
+			canonical = std::filesystem::absolute(path).lexically_normal();
+
+		auto key = canonical.string();
+
+#ifdef _WIN32
+		std::ranges::transform(key, key.begin(), [](char c) {
+			return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+		});
+#endif
+
+		return key;
+	}
+}
+
+namespace playground
+{
+#ifdef _WIN32
+	file_stamp stat_file(const char* path)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA data{};
+		if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+			throw std::system_error(GetLastError(), std::system_category(), "GetFileAttributesExA failed");
+
+		return {
+			.size = (std::uint64_t{ data.nFileSizeHigh } << 32) | data.nFileSizeLow,
+			.mtime = static_cast<std::int64_t>((std::uint64_t{ data.ftLastWriteTime.dwHighDateTime } << 32) | data.ftLastWriteTime.dwLowDateTime),
+		};
+	}
+#else
+	file_stamp stat_file(const char* path)
+	{
+		struct stat status {};
+		if (::stat(path, &status) != 0)
+			throw std::system_error(errno, std::generic_category(), "stat failed");
+
+		return {
+			.size = static_cast<std::uint64_t>(status.st_size),
+			.mtime = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1'000'000'000 + status.st_mtim.tv_nsec,
+		};
+	}
+#endif
+
+	std::shared_ptr<const std::string> file_cache::get(const char* path)
+	{
+		// Lexical, unlike the canonical key it does not touch the file
+		auto alias = std::filesystem::absolute(path).string();
+		const auto stamp = stat_file(path);
+
+		{
+			std::scoped_lock lock(mutex_);
+
+			if (auto it = aliases_.find(alias); it != aliases_.end())
+			{
+				if (it->second->stamp == stamp) {
+					++stats_.hits;
+					lru_.splice(lru_.begin(), lru_, it->second);
+					return it->second->content;
+				}
+
+				// The path may lead to another file by now, e.g. through a retargeted link
+				forget_alias(it);
+			}
+		}
+
+		auto key = cache_key(path);
+
+		{
+			std::scoped_lock lock(mutex_);
+
+			if (auto it = index_.find(key); it != index_.end())
+			{
+				if (it->second->stamp == stamp) {
+					++stats_.hits;
+					lru_.splice(lru_.begin(), lru_, it->second);
+					add_alias(it->second, std::move(alias));
+					return it->second->content;
+				}
+
+				++stats_.revalidations;
+				erase(it->second);
+			}
+
+			++stats_.misses;
+		}
+
+		// Read outside of the lock, concurrent misses of the same file may both read it
+		const auto file = mapped_file::open(path);
+		auto content = std::make_shared<const std::string>(file.view());
+
+		// The file changed while being read, hand it out but do not cache a possibly torn read
+		if (stat_file(path) != stamp || content->size() != stamp.size)
+			return content;
+
+		std::scoped_lock lock(mutex_);
+
+		if (content->size() > budget_ || index_.contains(key))
+			return content;
+
+		evict_to(budget_ - content->size());
+
+		lru_.push_front({ key, stamp, content, {} });
+		index_.emplace(std::move(key), lru_.begin());
+		add_alias(lru_.begin(), std::move(alias));
+		bytes_ += content->size();
+
+		return content;
+	}
+
+	void file_cache::set_budget(size_t budget_bytes)
+	{
+		std::scoped_lock lock(mutex_);
+
+		budget_ = budget_bytes;
+		evict_to(budget_);
+	}
+
+	file_cache_stats file_cache::stats() const
+	{
+		std::scoped_lock lock(mutex_);
+
+		auto stats = stats_;
+		stats.entries = index_.size();
+		stats.bytes = bytes_;
+		stats.budget = budget_;
+		return stats;
+	}
+
+	void file_cache::add_alias(std::list<entry>::iterator it, std::string alias)
+	{
+		if (it->aliases.size() >= MAX_ALIASES || aliases_.contains(alias))
+			return;
+
+		it->aliases.push_back(alias);
+		aliases_.emplace(std::move(alias), it);
+	}
+
+	void file_cache::forget_alias(alias_map::iterator alias)
+	{
+		std::erase(alias->second->aliases, alias->first);
+		aliases_.erase(alias);
+	}
+
+	void file_cache::erase(std::list<entry>::iterator it)
+	{
+		for (const auto& alias : it->aliases)
+			aliases_.erase(alias);
+
+		bytes_ -= it->content->size();
+		index_.erase(it->key);
+		lru_.erase(it);
+	}
+
+	void file_cache::evict_to(size_t budget_bytes)
+	{
+		while (bytes_ > budget_bytes && !lru_.empty())
+		{
+			erase(std::prev(lru_.end()));
+			++stats_.evictions;
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace playground
+{
+	struct file_cache_stats {
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t revalidations = 0; // cached but changed on disk, counted as misses too
+		std::uint64_t evictions = 0;
+		std::uint64_t entries = 0;
+		std::uint64_t bytes = 0;
+		std::uint64_t budget = 0;
+	};
+
+	/// Budget of the cache behind `get_file_content_cached`, changed with `set_file_cache_budget`
+	constexpr size_t DEFAULT_FILE_CACHE_BUDGET = 64 * 1024 * 1024;
+
+	/// Size and last write time, a cached entry is valid while both match the file on disk
+	struct file_stamp {
+		std::uint64_t size = 0;
+		std::int64_t mtime = 0;
+
+		friend bool operator==(const file_stamp&, const file_stamp&) = default;
+	};
+
+	/// Throws `std::system_error` when the file does not exist
+	[[nodiscard]] file_stamp stat_file(const char* path);
+
+	/// In-process cache of whole file contents keyed by canonical path, validated by size and
+	/// last write time on every lookup and bounded by a byte budget with LRU eviction. Content is
+	/// handed out as immutable shared buffers, so concurrent readers never copy it.
+	///
+	/// Resolving the canonical path opens the file on Windows, so it is done on a miss only: each
+	/// absolute path a hit arrived by is remembered with its entry, as long as the stamp matches.
+	class file_cache {
+	public:
+		explicit file_cache(size_t budget_bytes) : budget_(budget_bytes) {}
+
+		/// Throws `std::system_error` when the file cannot be read
+		[[nodiscard]] std::shared_ptr<const std::string> get(const char* path);
+
+		void set_budget(size_t budget_bytes);
+
+		[[nodiscard]] file_cache_stats stats() const;
+
+	private:
+		/// Absolute paths remembered per entry, more spellings of one file take the slow path
+		static constexpr size_t MAX_ALIASES = 8;
+
+		struct entry {
+			std::string key;
+			file_stamp stamp;
+			std::shared_ptr<const std::string> content;
+			std::vector<std::string> aliases;
+		};
+
+		using alias_map = std::unordered_map<std::string, std::list<entry>::iterator>;
+
+		void add_alias(std::list<entry>::iterator it, std::string alias);
+		void forget_alias(alias_map::iterator alias);
+		void erase(std::list<entry>::iterator it);
+		void evict_to(size_t budget_bytes);
+
+		mutable std::mutex mutex_;
+		std::list<entry> lru_; // most recently used first
+		std::unordered_map<std::string, std::list<entry>::iterator> index_;
+		alias_map aliases_;
+		size_t budget_ = 0;
+		size_t bytes_ = 0;
+		file_cache_stats stats_;
+	};
+}
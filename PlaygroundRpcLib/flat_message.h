@@ -0,0 +1,213 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// Flat binary messages which are read in place, without a parse step.
+///
+/// Layout (little-endian):
+///   header  { u32 magic, u16 schema id, u16 field count }
+///   offsets { u32 per field, 0 when the field is absent }
+///   data    { scalars stored as-is, strings as u32 length + bytes + '\0' }
+///
+/// Offsets are relative to the beginning of the buffer. A received buffer is validated
+/// once in O(field count) by `table_view::from`, after which an accessor is an offset load,
+/// a bounds check of the value against the buffer and the value load.
+namespace playground::flat
+{
+	static_assert(std::endian::native == std::endian::little, "flat messages assume a little-endian host");
+
+	constexpr std::uint32_t MAGIC = 0x4D464750; // "PGFM"
+
+	struct header {
+		std::uint32_t magic;
+		std::uint16_t schema_id;
+		std::uint16_t field_count;
+	};
+
+	template <class T>
+	concept scalar = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+	template <class T>
+	concept field_type = scalar<T> || std::same_as<T, std::string_view>;
+
+	/// Reads a trivially copyable value from a possibly unaligned address
+	template <class T>
+	[[nodiscard]] inline T load(const std::byte* ptr) noexcept
+	{
+		T value;
+		std::memcpy(&value, ptr, sizeof(T));
+		return value;
+	}
+
+	class table_view {
+	public:
+		/// Validates the header and every field offset, the only work done on a received buffer
+		[[nodiscard]] static std::optional<table_view> from(std::span<const std::byte> buffer, std::uint16_t schema_id) noexcept
+		{
+			if (buffer.size() < sizeof(header))
+				return std::nullopt;
+
+			const auto head = load<header>(buffer.data());
+			if (head.magic != MAGIC || head.schema_id != schema_id)
+				return std::nullopt;
+
+			const size_t table_end = sizeof(header) + size_t{ head.field_count } * sizeof(std::uint32_t);
+			if (buffer.size() < table_end)
+				return std::nullopt;
+
+			for (std::uint16_t i = 0; i < head.field_count; ++i)
+			{
+				const auto offset = load<std::uint32_t>(buffer.data() + sizeof(header) + i * sizeof(std::uint32_t));
+				if (offset != 0 && (offset < table_end || offset >= buffer.size()))
+					return std::nullopt;
+			}
+
+			return table_view{ buffer, head.field_count };
+		}
+
+		[[nodiscard]] std::uint32_t offset(std::uint16_t index) const noexcept
+		{
+			if (index >= field_count_)
+				return 0;
+
+			return load<std::uint32_t>(buffer_.data() + sizeof(header) + index * sizeof(std::uint32_t));
+		}
+
+		[[nodiscard]] bool has(std::uint16_t index) const noexcept { return offset(index) != 0; }
+
+		/// Returns the field value, or a default-constructed value when absent or out of bounds
+		template <field_type T>
+		[[nodiscard]] T get(std::uint16_t index) const noexcept
+		{
+			const auto off = offset(index);
+			if (off == 0)
+				return T{};
+
+			if constexpr (std::same_as<T, std::string_view>) {
+				if (buffer_.size() - off < sizeof(std::uint32_t))
+					return {};
+
+				const auto length = load<std::uint32_t>(buffer_.data() + off);
+				if (buffer_.size() - off - sizeof(std::uint32_t) < length)
+					return {};
+
+				return { reinterpret_cast<const char*>(buffer_.data() + off + sizeof(std::uint32_t)), length };
+			}
+			else {
+				if (buffer_.size() - off < sizeof(T))
+					return T{};
+
+				return load<T>(buffer_.data() + off);
+			}
+		}
+
+	private:
+		table_view(std::span<const std::byte> buffer, std::uint16_t field_count) noexcept
+			: buffer_(buffer), field_count_(field_count) {}
+
+		std::span<const std::byte> buffer_;
+		std::uint16_t field_count_ = 0;
+	};
+
+	class table_builder {
+	public:
+		table_builder(std::uint16_t schema_id, std::uint16_t field_count)
+			: field_count_(field_count)
+		{
+			const size_t table_end = sizeof(header) + size_t{ field_count } * sizeof(std::uint32_t);
+			buffer_.resize(table_end);
+			store(0, header{ MAGIC, schema_id, field_count });
+		}
+
+		template <field_type T>
+		void set(std::uint16_t index, const T& value)
+		{
+			if (index >= field_count_)
+				return;
+
+			if constexpr (std::same_as<T, std::string_view>) {
+				const auto off = append_aligned(alignof(std::uint32_t), sizeof(std::uint32_t) + value.size() + 1);
+				store(off, static_cast<std::uint32_t>(value.size()));
+				if (!value.empty())
+					std::memcpy(buffer_.data() + off + sizeof(std::uint32_t), value.data(), value.size());
+				set_offset(index, off);
+			}
+			else {
+				const auto off = append_aligned(alignof(T), sizeof(T));
+				store(off, value);
+				set_offset(index, off);
+			}
+		}
+
+		[[nodiscard]] std::vector<std::byte> finish() && { return std::move(buffer_); }
+
+	private:
+		template <class T>
+		void store(size_t offset, const T& value) noexcept
+		{
+			std::memcpy(buffer_.data() + offset, &value, sizeof(T));
+		}
+
+		void set_offset(std::uint16_t index, size_t offset) noexcept
+		{
+			store(sizeof(header) + index * sizeof(std::uint32_t), static_cast<std::uint32_t>(offset));
+		}
+
+		/// Appends zeroed storage and returns its offset
+		size_t append_aligned(size_t alignment, size_t size)
+		{
+			const size_t offset = (buffer_.size() + alignment - 1) & ~(alignment - 1);
+			buffer_.resize(offset + size);
+			return offset;
+		}
+
+		std::vector<std::byte> buffer_;
+		std::uint16_t field_count_ = 0;
+	};
+}
+
+// Schema tables are declared with an X-macro listing `FIELD(index, name, type)` entries,
+// from which PLAYGROUND_FLAT_TABLE generates a `<table>_view` with one accessor per field
+// and a `<table>_builder` with one setter per field. See `flat_schema.h`.
+
+#define PLAYGROUND_FLAT_COUNT(index, name, type) + 1
+
+#define PLAYGROUND_FLAT_ACCESSOR(index, name, type) \
+	[[nodiscard]] type name() const noexcept { return view_.get<type>(index); } \
+	[[nodiscard]] bool has_##name() const noexcept { return view_.has(index); }
+
+#define PLAYGROUND_FLAT_SETTER(index, name, type) \
+	auto& name(const type& value) { builder_.set<type>(index, value); return *this; }
+
+#define PLAYGROUND_FLAT_TABLE(table, schema, FIELDS) \
+	class table##_view { \
+	public: \
+		static constexpr std::uint16_t schema_id = schema; \
+		static constexpr std::uint16_t field_count = 0 FIELDS(PLAYGROUND_FLAT_COUNT); \
+		[[nodiscard]] static std::optional<table##_view> from(std::span<const std::byte> buffer) noexcept { \
+			if (auto view = ::playground::flat::table_view::from(buffer, schema_id)) \
+				return table##_view{ *view }; \
+			return std::nullopt; \
+		} \
+		FIELDS(PLAYGROUND_FLAT_ACCESSOR) \
+	private: \
+		explicit table##_view(::playground::flat::table_view view) noexcept : view_(view) {} \
+		::playground::flat::table_view view_; \
+	}; \
+	class table##_builder { \
+	public: \
+		table##_builder() : builder_(table##_view::schema_id, table##_view::field_count) {} \
+		FIELDS(PLAYGROUND_FLAT_SETTER) \
+		[[nodiscard]] std::vector<std::byte> finish() { return std::move(builder_).finish(); } \
+	private: \
+		::playground::flat::table_builder builder_; \
+	};
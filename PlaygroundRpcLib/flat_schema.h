@@ -0,0 +1,18 @@
+#pragma once
+
+#include "flat_message.h"
+
+/// Schemas of structured messages carried by `pass_and_get_bytes`.
+/// Field indices are part of the wire format, append new fields and never reuse an index.
+namespace playground::messages
+{
+#define PLAYGROUND_RECORD_FIELDS(FIELD) \
+	FIELD(0, id, std::uint64_t) \
+	FIELD(1, name, std::string_view) \
+	FIELD(2, path, std::string_view) \
+	FIELD(3, size, std::uint64_t) \
+	FIELD(4, flags, std::uint32_t) \
+	FIELD(5, payload, std::string_view)
+
+	PLAYGROUND_FLAT_TABLE(record, 1, PLAYGROUND_RECORD_FIELDS)
+}
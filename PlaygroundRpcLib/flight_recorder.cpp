@@ -0,0 +1,318 @@
+#include "flight_recorder.h"
+
+#include "call_trace.h"
+#include "leaked_singleton.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+namespace
+{
+	using playground::flight_recorder::call_entry;
+
+	static_assert(std::is_trivially_copyable_v<call_entry> && sizeof(call_entry) % sizeof(std::uint64_t) == 0);
+
+	/// Seqlock per slot: a writer claims a unique index, marks the slot odd while writing and even
+	/// when done, a reader keeps an entry only if the slot held the expected even value throughout
+	template <size_t Capacity>
+	class ring {
+	public:
+		void push(const call_entry& entry) noexcept
+		{
+			const auto index = head_.fetch_add(1, std::memory_order_relaxed);
+			auto& s = slots_[index % Capacity];
+
+			const auto words = std::bit_cast<std::array<std::uint64_t, WORDS>>(entry);
+
+			s.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			for (size_t i = 0; i < WORDS; ++i)
+				s.words[i].store(words[i], std::memory_order_relaxed);
+
+			s.sequence.store(index * 2 + 2, std::memory_order_release);
+		}
+
+		[[nodiscard]] std::vector<call_entry> snapshot() const
+		{
+			const auto head = head_.load(std::memory_order_acquire);
+			const auto first = head > Capacity ? head - Capacity : 0;
+
+			std::vector<call_entry> entries;
+			entries.reserve(static_cast<size_t>(head - first));
+
+			for (auto index = first; index < head; ++index)
+			{
+				const auto& s = slots_[index % Capacity];
+
+				const auto before = s.sequence.load(std::memory_order_acquire);
+				if (before != index * 2 + 2)
+					continue;
+
+				std::array<std::uint64_t, WORDS> words;
+				for (size_t i = 0; i < WORDS; ++i)
+					words[i] = s.words[i].load(std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (s.sequence.load(std::memory_order_relaxed) != before)
+					continue;
+
+				entries.push_back(std::bit_cast<call_entry>(words));
+			}
+
+			return entries;
+		}
+
+	private:
+		static constexpr size_t WORDS = sizeof(call_entry) / sizeof(std::uint64_t);
+
+		struct slot {
+			std::atomic<std::uint64_t> sequence{ 0 };
+			std::array<std::atomic<std::uint64_t>, WORDS> words{};
+		};
+
+		std::atomic<std::uint64_t> head_{ 0 };
+		std::array<slot, Capacity> slots_{};
+	};
+
+	ring<playground::flight_recorder::RECENT_CAPACITY> recent_calls;
+	ring<playground::flight_recorder::SLOW_CAPACITY> slow_calls;
+	std::atomic<std::uint64_t> slow_threshold_ns{ playground::flight_recorder::DEFAULT_SLOW_THRESHOLD_NS };
+
+	/// Counts calls over the threshold per window on the hot path, dumps on its own thread
+	class p99_guard {
+	public:
+		void observe(std::uint64_t total_ns) noexcept
+		{
+			if (!armed_.load(std::memory_order_relaxed))
+				return;
+
+			if (total_ns > threshold_ns_.load(std::memory_order_relaxed))
+				over_.fetch_add(1, std::memory_order_relaxed);
+
+			const auto window = window_calls_.load(std::memory_order_relaxed);
+			if (seen_.fetch_add(1, std::memory_order_relaxed) + 1 != window)
+				return;
+
+			// Calls racing with the end of the window may be counted in either window
+			const auto over = over_.exchange(0, std::memory_order_relaxed);
+			seen_.store(0, std::memory_order_relaxed);
+
+			if (over * 100 > window)
+				trip();
+		}
+
+		void arm(playground::flight_recorder::guard_options options)
+		{
+			disarm();
+
+			std::scoped_lock lock(mutex_);
+			options_ = std::move(options);
+			options_.window_calls = std::max<std::uint32_t>(options_.window_calls, 100);
+			pending_ = false;
+
+			threshold_ns_.store(options_.p99_threshold_ns, std::memory_order_relaxed);
+			window_calls_.store(options_.window_calls, std::memory_order_relaxed);
+			seen_.store(0, std::memory_order_relaxed);
+			over_.store(0, std::memory_order_relaxed);
+
+			dumper_ = std::jthread([this](std::stop_token stop) { run(stop); });
+			armed_.store(true, std::memory_order_relaxed);
+		}
+
+		void disarm()
+		{
+			armed_.store(false, std::memory_order_relaxed);
+
+			std::jthread dumper;
+			{
+				std::scoped_lock lock(mutex_);
+				dumper = std::move(dumper_);
+			}
+
+			// Requests stop and joins on destruction
+		}
+
+		[[nodiscard]] std::uint64_t dumps() const noexcept
+		{
+			return dumps_.load(std::memory_order_relaxed);
+		}
+
+	private:
+		void trip() noexcept
+		{
+			{
+				std::scoped_lock lock(mutex_);
+				pending_ = true;
+			}
+			wake_.notify_one();
+		}
+
+		void run(std::stop_token stop)
+		{
+			std::optional<std::chrono::steady_clock::time_point> last_dump;
+
+			std::unique_lock lock(mutex_);
+			while (wake_.wait(lock, stop, [&] { return pending_; }))
+			{
+				pending_ = false;
+
+				const auto now = std::chrono::steady_clock::now();
+				if (last_dump && now - *last_dump < options_.cooldown)
+					continue;
+
+				last_dump = now;
+				const auto path = std::filesystem::path(options_.directory) / std::format("flight-{}.json", playground::trace::now_ns());
+
+				lock.unlock();
+				try {
+					playground::flight_recorder::dump(path.string());
+					dumps_.fetch_add(1, std::memory_order_relaxed);
+				}
+				catch (const std::exception&) {
+					// Nowhere to report it from this thread, the dump counter does not move
+				}
+				lock.lock();
+			}
+		}
+
+		std::atomic<bool> armed_{ false };
+		std::atomic<std::uint64_t> threshold_ns_{ 0 };
+		std::atomic<std::uint32_t> window_calls_{ 0 };
+		std::atomic<std::uint32_t> seen_{ 0 };
+		std::atomic<std::uint32_t> over_{ 0 };
+		std::atomic<std::uint64_t> dumps_{ 0 };
+
+		std::mutex mutex_;
+		std::condition_variable_any wake_;
+		bool pending_ = false;
+		playground::flight_recorder::guard_options options_;
+		std::jthread dumper_;
+	};
+
+	p99_guard& get_guard()
+	{
+		return playground::leaked_singleton<p99_guard>();
+	}
+
+	constexpr std::array<const char*, static_cast<size_t>(playground::metrics::side::count)> SIDE_NAMES{
+		"client",
+		"server",
+	};
+
+	constexpr std::array<const char*, static_cast<size_t>(playground::metrics::method::count)> METHOD_NAMES{
+		"pass_and_get_string",
+		"pass_and_get_bytes",
+		"pass_hash_and_get_string",
+		"pass_hashed_and_get_string",
+		"pass_delta_and_get_string",
+		"invoke",
+	};
+
+	void append_entries(std::string& out, const std::vector<call_entry>& entries)
+	{
+		out += '[';
+		for (const auto& e : entries)
+		{
+			std::format_to(
+				std::back_inserter(out),
+				R"({{"end_ns":{},"call_id":"{:016x}","side":"{}","method":"{}","status":{},"bytes_in":{},"bytes_out":{},"total_ns":{},"callback_ns":{},"reply_copy_ns":{},"take_reply_ns":{}}},)",
+				e.end_ns,
+				e.call_id,
+				SIDE_NAMES[static_cast<size_t>(e.side)],
+				METHOD_NAMES[static_cast<size_t>(e.method)],
+				e.status,
+				e.bytes_in,
+				e.bytes_out,
+				e.total_ns,
+				e.phase_ns[static_cast<size_t>(playground::metrics::phase::callback)],
+				e.phase_ns[static_cast<size_t>(playground::metrics::phase::reply_copy)],
+				e.phase_ns[static_cast<size_t>(playground::metrics::phase::take_reply)]);
+		}
+
+		if (out.back() == ',')
+			out.pop_back();
+		out += ']';
+	}
+}
+
+namespace playground::flight_recorder
+{
+	void record(const call_entry& entry) noexcept
+	{
+		if (static_cast<size_t>(entry.side) >= SIDE_NAMES.size() || static_cast<size_t>(entry.method) >= METHOD_NAMES.size())
+			return;
+
+		recent_calls.push(entry);
+
+		if (entry.total_ns >= slow_threshold_ns.load(std::memory_order_relaxed))
+			slow_calls.push(entry);
+
+		get_guard().observe(entry.total_ns);
+	}
+
+	void set_slow_threshold(std::uint64_t threshold_ns) noexcept
+	{
+		slow_threshold_ns.store(threshold_ns, std::memory_order_relaxed);
+	}
+
+	std::vector<call_entry> recent()
+	{
+		return recent_calls.snapshot();
+	}
+
+	std::vector<call_entry> slow()
+	{
+		return slow_calls.snapshot();
+	}
+
+	std::string to_json()
+	{
+		std::string out = R"({"recent":)";
+		append_entries(out, recent());
+		out += R"(,"slow":)";
+		append_entries(out, slow());
+		out += '}';
+		return out;
+	}
+
+	void dump(const std::string& path)
+	{
+		const auto json = to_json();
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+			throw std::system_error(errno, std::generic_category(), "flight recorder dump could not be created");
+
+		file.write(json.data(), static_cast<std::streamsize>(json.size()));
+		if (!file)
+			throw std::system_error(errno, std::generic_category(), "flight recorder dump could not be written");
+	}
+
+	void arm(guard_options options)
+	{
+		get_guard().arm(std::move(options));
+	}
+
+	void disarm()
+	{
+		get_guard().disarm();
+	}
+
+	std::uint64_t auto_dumps() noexcept
+	{
+		return get_guard().dumps();
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "call_metrics.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Always-on record of the last calls of this process, kept in two fixed-size lock-free rings: one
+/// for every call and one for calls slower than a threshold, so a tail latency incident can be
+/// looked at after the fact. Fed by `metrics::call_scope`.
+namespace playground::flight_recorder
+{
+	constexpr size_t RECENT_CAPACITY = 1024;
+	constexpr size_t SLOW_CAPACITY = 256;
+	constexpr std::uint64_t DEFAULT_SLOW_THRESHOLD_NS = 10'000'000;
+
+	struct call_entry {
+		/// Monotonic, same clock as `trace::now_ns`
+		std::uint64_t end_ns = 0;
+		std::uint64_t call_id = 0;
+		metrics::side side = metrics::side::client;
+		metrics::method method = metrics::method::pass_and_get_string;
+		std::uint32_t status = 0;
+		std::uint32_t reserved = 0;
+		std::uint64_t bytes_in = 0;
+		std::uint64_t bytes_out = 0;
+		std::uint64_t total_ns = 0;
+		std::array<std::uint64_t, static_cast<size_t>(metrics::phase::count)> phase_ns{};
+	};
+
+	void record(const call_entry& entry) noexcept;
+
+	void set_slow_threshold(std::uint64_t threshold_ns) noexcept;
+
+	/// Oldest first. Entries being overwritten while they are read are skipped.
+	[[nodiscard]] std::vector<call_entry> recent();
+	[[nodiscard]] std::vector<call_entry> slow();
+
+	/// Both rings as JSON, `{"recent":[...],"slow":[...]}`
+	[[nodiscard]] std::string to_json();
+
+	/// Throws `std::system_error` when the file cannot be written
+	void dump(const std::string& path);
+
+	struct guard_options {
+		/// Dumps are written there as `flight-<end_ns>.json`
+		std::string directory;
+		/// The guard trips when more than 1% of the calls of a window are slower than this
+		std::uint64_t p99_threshold_ns = DEFAULT_SLOW_THRESHOLD_NS;
+		std::uint32_t window_calls = 1000;
+		/// Minimum time between two dumps, so a sustained incident does not fill the disk
+		std::chrono::seconds cooldown{ 60 };
+	};
+
+	/// Watches the p99 latency of all calls and dumps both rings from a background thread when it
+	/// goes over the threshold. Arming again replaces the options.
+	void arm(guard_options options);
+
+	void disarm();
+
+	/// Number of dumps written by the guard
+	[[nodiscard]] std::uint64_t auto_dumps() noexcept;
+}
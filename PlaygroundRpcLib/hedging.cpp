@@ -0,0 +1,318 @@
+#include "hedging.h"
+
+#include "deadline.h"
+#include "error_log.h"
+#include "playground_client.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <Windows.h>
+
+namespace
+{
+	constexpr std::int64_t DELAY_REFRESH_NS = 100'000'000;
+	constexpr std::uint64_t MIN_OBSERVED_CALLS = 100;
+	constexpr double HEDGE_BURST = 10;
+
+	[[nodiscard]] std::int64_t steady_ns() noexcept
+	{
+		return static_cast<std::int64_t>(playground::deadline::to_ns(playground::deadline::clock::now()));
+	}
+}
+
+namespace playground::client
+{
+	/// Shared by the calling thread and the thread sending the duplicate
+	struct hedged_client::call {
+		/// Read only while `done` is not set, the caller returns right after setting it
+		const std::string* request = nullptr;
+		std::uint32_t primary = 0;
+
+		deadline::call_canceller primary_cancel;
+		deadline::call_canceller hedge_cancel;
+
+		/// Each attempt disarms its canceller under it once its call returned, and the other side
+		/// cancels under it only while that call is still running, so a cancel never reaches a
+		/// thread that has moved on
+		std::mutex mutex;
+		std::condition_variable hedge_finished;
+		bool done = false;
+		bool primary_returned = false;
+		bool hedge_running = false;
+		std::optional<std::string> hedge_reply;
+
+		/// Guarded by the client's mutex
+		timer_queue::iterator timer;
+		bool scheduled = false;
+	};
+
+	hedged_client::hedged_client(std::span<const std::string> endpoints, hedge_options options)
+		: options_(options),
+		budget_(options.max_hedge_ratio, HEDGE_BURST),
+		delay_ns_(options.initial_delay.count())
+	{
+		if (endpoints.size() < 2)
+			throw std::invalid_argument{ "hedging needs at least two endpoints" };
+
+		try {
+			bindings_.reserve(endpoints.size());
+			for (const auto& endpoint : endpoints)
+				bindings_.push_back(connect(endpoint.c_str()));
+
+			timer_ = std::jthread([this](std::stop_token stop) { run_timers(stop); });
+		}
+		catch (...) {
+			free_bindings();
+			throw;
+		}
+	}
+
+	hedged_client::~hedged_client()
+	{
+		// Requests stop and joins, then waits for the duplicates still in flight on the thread pool
+		timer_ = {};
+		{
+			std::unique_lock lock(mutex_);
+			hedges_idle_.wait(lock, [&] { return hedges_in_flight_ == 0; });
+		}
+		free_bindings();
+	}
+
+	std::string hedged_client::pass_and_get_string(const std::string& str)
+	{
+		calls_.fetch_add(1, std::memory_order_relaxed);
+
+		const auto primary = next_.fetch_add(1, std::memory_order_relaxed) % static_cast<std::uint32_t>(bindings_.size());
+
+		// The callback runs on this thread then, there is nothing to cancel
+		if (calls_in_process(bindings_[primary]))
+			return client::pass_and_get_string(bindings_[primary], str);
+
+		budget_.deposit();
+
+		auto c = std::make_shared<call>();
+		c->request = &str;
+		c->primary = primary;
+
+		bool earliest = false;
+		const auto due = std::chrono::steady_clock::now() + delay();
+		{
+			std::scoped_lock lock(mutex_);
+			c->timer = timers_.emplace(due, c);
+			c->scheduled = true;
+			earliest = c->timer == timers_.begin();
+		}
+
+		if (earliest)
+			wake_.notify_one();
+
+		// Cancelled before it started only when the duplicate already won
+		rpc_result<std::string> reply = std::unexpected(rpc_error{ RPC_S_CALL_CANCELLED, "pass_and_get_string" });
+		std::chrono::nanoseconds latency{};
+		if (c->primary_cancel.arm()) {
+			const auto start = std::chrono::steady_clock::now();
+			reply = try_pass_and_get_string(bindings_[c->primary], str.c_str());
+			latency = std::chrono::steady_clock::now() - start;
+		}
+
+		{
+			std::scoped_lock lock(c->mutex);
+			c->primary_cancel.disarm();
+			c->primary_returned = true;
+		}
+
+		if (reply)
+			record_latency(latency);
+
+		{
+			std::scoped_lock lock(mutex_);
+			if (c->scheduled) {
+				timers_.erase(c->timer);
+				c->scheduled = false;
+			}
+		}
+
+		std::unique_lock lock(c->mutex);
+		if (!reply && !c->hedge_reply) {
+			// The duplicate may still succeed where the primary attempt failed
+			c->hedge_finished.wait(lock, [&] { return !c->hedge_running; });
+		}
+
+		c->done = true;
+
+		if (c->hedge_reply) {
+			hedge_wins_.fetch_add(1, std::memory_order_relaxed);
+			return std::move(*c->hedge_reply);
+		}
+
+		if (c->hedge_running)
+			c->hedge_cancel.cancel();
+
+		lock.unlock();
+		return value_or_throw(std::move(reply));
+	}
+
+	hedge_stats hedged_client::stats() const noexcept
+	{
+		return {
+			.calls = calls_.load(std::memory_order_relaxed),
+			.hedges = hedges_.load(std::memory_order_relaxed),
+			.hedge_wins = hedge_wins_.load(std::memory_order_relaxed),
+			.over_budget = over_budget_.load(std::memory_order_relaxed),
+		};
+	}
+
+	std::chrono::nanoseconds hedged_client::delay() noexcept
+	{
+		if (options_.delay.count() > 0)
+			return options_.delay;
+
+		// One caller at a time walks the histogram, the others keep the previous value
+		const auto now = steady_ns();
+		auto updated = delay_updated_ns_.load(std::memory_order_relaxed);
+		if (now - updated >= DELAY_REFRESH_NS && delay_updated_ns_.compare_exchange_strong(updated, now, std::memory_order_relaxed)) {
+			std::scoped_lock lock(latency_mutex_);
+			if (latency_.total >= MIN_OBSERVED_CALLS)
+				delay_ns_.store(static_cast<std::int64_t>(latency_.value_at_percentile(95)), std::memory_order_relaxed);
+		}
+
+		return std::chrono::nanoseconds{ delay_ns_.load(std::memory_order_relaxed) };
+	}
+
+	void hedged_client::run_timers(std::stop_token stop)
+	{
+		std::unique_lock lock(mutex_);
+		while (!stop.stop_requested())
+		{
+			if (timers_.empty()) {
+				wake_.wait(lock, stop, [&] { return !timers_.empty(); });
+				continue;
+			}
+
+			const auto due = timers_.begin()->first;
+			if (std::chrono::steady_clock::now() < due) {
+				wake_.wait_until(lock, stop, due, [&] { return !timers_.empty() && timers_.begin()->first < due; });
+				continue;
+			}
+
+			auto c = std::move(timers_.begin()->second);
+			c->scheduled = false;
+			timers_.erase(timers_.begin());
+
+			lock.unlock();
+			try {
+				start_hedge(c);
+			}
+			catch (const std::exception& e) {
+				error_log::report(e.what());
+			}
+			lock.lock();
+		}
+	}
+
+	void hedged_client::start_hedge(const std::shared_ptr<call>& c)
+	{
+		struct hedge_work {
+			hedged_client* client = nullptr;
+			std::shared_ptr<call> c;
+			std::string request;
+		};
+
+		auto work = std::make_unique<hedge_work>(this, c);
+		{
+			std::scoped_lock lock(c->mutex);
+			if (c->done)
+				return;
+
+			if (!budget_.try_withdraw()) {
+				over_budget_.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			work->request = *c->request;
+			c->hedge_running = true;
+		}
+
+		{
+			std::scoped_lock lock(mutex_);
+			++hedges_in_flight_;
+		}
+
+		const auto submitted = TrySubmitThreadpoolCallback(
+			[](PTP_CALLBACK_INSTANCE, void* context) {
+				const std::unique_ptr<hedge_work> work(static_cast<hedge_work*>(context));
+				work->client->send_hedge(*work->c, work->request);
+			},
+			work.get(),
+			nullptr /* default environment */);
+
+		if (submitted) {
+			work.release();
+			return;
+		}
+
+		const auto error = GetLastError();
+		{
+			std::scoped_lock lock(c->mutex);
+			c->hedge_running = false;
+		}
+		c->hedge_finished.notify_all();
+		finish_hedge();
+
+		throw std::system_error(error, std::system_category(), "TrySubmitThreadpoolCallback failed");
+	}
+
+	void hedged_client::send_hedge(call& c, const std::string& request)
+	{
+		hedges_.fetch_add(1, std::memory_order_relaxed);
+		const auto target = (c.primary + 1) % static_cast<std::uint32_t>(bindings_.size());
+
+		rpc_result<std::string> reply = std::unexpected(rpc_error{ RPC_S_CALL_CANCELLED, "pass_and_get_string" });
+		if (c.hedge_cancel.arm())
+			reply = try_pass_and_get_string(bindings_[target], request.c_str());
+
+		{
+			std::scoped_lock lock(c.mutex);
+			c.hedge_cancel.disarm();
+			c.hedge_running = false;
+
+			if (reply && !c.done) {
+				c.hedge_reply = std::move(*reply);
+
+				if (!c.primary_returned)
+					c.primary_cancel.cancel();
+			}
+		}
+		c.hedge_finished.notify_all();
+
+		finish_hedge();
+	}
+
+	void hedged_client::finish_hedge() noexcept
+	{
+		// Notified under the lock, the destructor may run as soon as it is released
+		std::scoped_lock lock(mutex_);
+		--hedges_in_flight_;
+		hedges_idle_.notify_all();
+	}
+
+	void hedged_client::record_latency(std::chrono::nanoseconds latency) noexcept
+	{
+		const auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0));
+
+		std::scoped_lock lock(latency_mutex_);
+		++latency_.buckets[histogram_buckets::index_of(ns)];
+		++latency_.total;
+		latency_.max = std::max(latency_.max, ns);
+	}
+
+	void hedged_client::free_bindings() noexcept
+	{
+		for (auto& handle : bindings_)
+			free_binding(handle);
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "latency_histogram.h"
+#include "playground_rpc.h"
+#include "token_bucket.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace playground::client
+{
+	struct hedge_options {
+		/// Wait before the duplicate is sent, or 0 to follow the observed p95 latency of this client's
+		/// own calls
+		std::chrono::nanoseconds delay{ 0 };
+
+		/// Followed delay until enough calls were observed
+		std::chrono::nanoseconds initial_delay = std::chrono::milliseconds(10);
+
+		/// Duplicates allowed per call, on top of a small burst
+		double max_hedge_ratio = 0.05;
+	};
+
+	struct hedge_stats {
+		std::uint64_t calls = 0;
+		std::uint64_t hedges = 0;
+
+		/// Calls answered by the duplicate
+		std::uint64_t hedge_wins = 0;
+
+		/// Duplicates not sent because the budget ran out
+		std::uint64_t over_budget = 0;
+	};
+
+	/// Sends `pass_and_get_string` to one of several replica endpoints and, when no reply arrived
+	/// within the delay, a duplicate to the next one. The first reply wins and the other attempt is
+	/// cancelled. Only for idempotent callbacks, the server may run both attempts. Calls whose replica
+	/// is served by this process take the in-process path, cannot be cancelled and are not hedged.
+	class hedged_client {
+	public:
+		hedged_client(std::span<const std::string> endpoints, hedge_options options);
+		~hedged_client();
+
+		hedged_client(const hedged_client&) = delete;
+		hedged_client& operator=(const hedged_client&) = delete;
+
+		std::string pass_and_get_string(const std::string& str);
+
+		[[nodiscard]] hedge_stats stats() const noexcept;
+
+		/// Delay the next call waits before hedging
+		[[nodiscard]] std::chrono::nanoseconds delay() noexcept;
+
+	private:
+		struct call;
+		using timer_queue = std::multimap<std::chrono::steady_clock::time_point, std::shared_ptr<call>>;
+
+		void run_timers(std::stop_token stop);
+
+		/// Hands the duplicate to the thread pool, so a stalled one does not hold up the next timers
+		void start_hedge(const std::shared_ptr<call>& c);
+		void send_hedge(call& c, const std::string& request);
+		void finish_hedge() noexcept;
+
+		void record_latency(std::chrono::nanoseconds latency) noexcept;
+		void free_bindings() noexcept;
+
+		std::vector<handle_t> bindings_;
+		hedge_options options_;
+		token_bucket budget_;
+		std::atomic<std::uint32_t> next_{ 0 };
+
+		std::atomic<std::int64_t> delay_ns_{ 0 };
+		std::atomic<std::int64_t> delay_updated_ns_{ 0 };
+
+		/// Primary attempts which got a reply, the delay follows their p95
+		std::mutex latency_mutex_;
+		latency_counts latency_;
+
+		std::atomic<std::uint64_t> calls_{ 0 };
+		std::atomic<std::uint64_t> hedges_{ 0 };
+		std::atomic<std::uint64_t> hedge_wins_{ 0 };
+		std::atomic<std::uint64_t> over_budget_{ 0 };
+
+		std::mutex mutex_;
+		std::condition_variable_any wake_;
+		timer_queue timers_;
+
+		/// Duplicates handed to the thread pool and not finished yet, the destructor waits for them
+		std::condition_variable hedges_idle_;
+		size_t hedges_in_flight_ = 0;
+
+		std::jthread timer_;
+	};
+}
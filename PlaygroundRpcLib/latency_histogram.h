@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace playground
+{
+	/// Log-linear bucketing in the spirit of HdrHistogram: values below 2^SUB_BUCKET_BITS are exact,
+	/// above that every power of two is split into 2^SUB_BUCKET_BITS linear buckets, so a reported
+	/// value is never off by more than 1/16 (about 6%) of the true value.
+	namespace histogram_buckets
+	{
+		constexpr unsigned SUB_BUCKET_BITS = 4;
+		constexpr std::uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+
+		/// Values at or above 2^MAX_BITS, about 18 minutes in nanoseconds, land in the last bucket
+		constexpr unsigned MAX_BITS = 40;
+
+		constexpr size_t COUNT = SUB_BUCKETS + (MAX_BITS - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+		[[nodiscard]] constexpr size_t index_of(std::uint64_t value) noexcept
+		{
+			if (value < SUB_BUCKETS)
+				return static_cast<size_t>(value);
+
+			value = std::min<std::uint64_t>(value, (1ull << MAX_BITS) - 1);
+
+			const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+			return static_cast<size_t>(SUB_BUCKETS + shift * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+		}
+
+		/// Highest value that falls into the bucket
+		[[nodiscard]] constexpr std::uint64_t upper_bound_of(size_t index) noexcept
+		{
+			if (index < SUB_BUCKETS)
+				return index;
+
+			const auto shift = static_cast<unsigned>((index - SUB_BUCKETS) / SUB_BUCKETS);
+			const auto sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+			return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+		}
+	}
+
+	/// Plain bucket counts, the merged result of one or more `latency_histogram`s
+	struct latency_counts {
+		std::array<std::uint64_t, histogram_buckets::COUNT> buckets{};
+		std::uint64_t total = 0;
+		std::uint64_t max = 0;
+
+		/// Upper bound of the bucket holding the given percentile (0-100), capped by the exact maximum
+		[[nodiscard]] std::uint64_t value_at_percentile(double percentile) const noexcept
+		{
+			if (total == 0)
+				return 0;
+
+			const auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total))));
+
+			std::uint64_t seen = 0;
+			for (size_t i = 0; i < buckets.size(); ++i)
+			{
+				seen += buckets[i];
+				if (seen >= target)
+					return std::min(histogram_buckets::upper_bound_of(i), max);
+			}
+
+			return max;
+		}
+	};
+
+	/// Histogram with a single writer and any number of concurrent readers. Recording is a relaxed
+	/// load and store, no read-modify-write, so it is only correct while one thread owns it.
+	class latency_histogram {
+	public:
+		void record(std::uint64_t value) noexcept
+		{
+			bump(buckets_[histogram_buckets::index_of(value)]);
+
+			if (value > max_.load(std::memory_order_relaxed))
+				max_.store(value, std::memory_order_relaxed);
+		}
+
+		void add_to(latency_counts& counts) const noexcept
+		{
+			for (size_t i = 0; i < buckets_.size(); ++i)
+			{
+				const auto count = buckets_[i].load(std::memory_order_relaxed);
+				counts.buckets[i] += count;
+				counts.total += count;
+			}
+
+			counts.max = std::max(counts.max, max_.load(std::memory_order_relaxed));
+		}
+
+		void reset() noexcept
+		{
+			for (auto& bucket : buckets_)
+				bucket.store(0, std::memory_order_relaxed);
+			max_.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		static void bump(std::atomic<std::uint64_t>& counter) noexcept
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		std::array<std::atomic<std::uint64_t>, histogram_buckets::COUNT> buckets_{};
+		std::atomic<std::uint64_t> max_{ 0 };
+	};
+}
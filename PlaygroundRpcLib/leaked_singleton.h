@@ -0,0 +1,14 @@
+#pragma once
+
+namespace playground
+{
+	/// The process-wide instance of `T`, created on first use and never destroyed. For owners of a
+	/// background thread: a static destructor runs on DLL_PROCESS_DETACH under the loader lock, and
+	/// joining the thread there could deadlock. The thread ends with the process instead.
+	template <class T>
+	[[nodiscard]] T& leaked_singleton()
+	{
+		static auto* instance = new T();
+		return *instance;
+	}
+}
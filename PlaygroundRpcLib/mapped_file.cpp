@@ -0,0 +1,127 @@
+#include "mapped_file.h"
+
+#include "../Common/defer.h"
+
+#include <limits>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace playground
+{
+#ifdef _WIN32
+	mapped_file mapped_file::open(const char* path)
+	{
+		auto handle = CreateFileA(
+			path,
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+			nullptr);
+
+		if (handle == INVALID_HANDLE_VALUE)
+			throw std::system_error(GetLastError(), std::system_category(), "CreateFileA failed");
+
+		defer(std::ignore = CloseHandle(handle));
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(handle, &file_size))
+			throw std::system_error(GetLastError(), std::system_category(), "GetFileSizeEx failed");
+
+		// A zero-length file cannot be mapped
+		if (file_size.QuadPart == 0)
+			return {};
+
+		if (static_cast<unsigned long long>(file_size.QuadPart) > std::numeric_limits<size_t>::max())
+			throw std::system_error(ERROR_FILE_TOO_LARGE, std::system_category(), "file does not fit the address space");
+
+		auto mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+			throw std::system_error(GetLastError(), std::system_category(), "CreateFileMappingA failed");
+
+		// The view keeps the mapping object alive
+		defer(std::ignore = CloseHandle(mapping));
+
+		auto* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr)
+			throw std::system_error(GetLastError(), std::system_category(), "MapViewOfFile failed");
+
+		return { static_cast<const char*>(data), static_cast<size_t>(file_size.QuadPart) };
+	}
+
+	void mapped_file::unmap() noexcept
+	{
+		if (data_ != nullptr)
+			std::ignore = UnmapViewOfFile(data_);
+	}
+#else
+	mapped_file mapped_file::open(const char* path)
+	{
+		const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			throw std::system_error(errno, std::generic_category(), "open failed");
+
+		defer(std::ignore = ::close(fd));
+
+		struct stat status {};
+		if (::fstat(fd, &status) != 0)
+			throw std::system_error(errno, std::generic_category(), "fstat failed");
+
+		// A zero-length file cannot be mapped
+		if (status.st_size == 0)
+			return {};
+
+		if (static_cast<unsigned long long>(status.st_size) > std::numeric_limits<size_t>::max())
+			throw std::system_error(EFBIG, std::generic_category(), "file does not fit the address space");
+
+		const auto size = static_cast<size_t>(status.st_size);
+
+		// The mapping stays valid after the descriptor is closed
+		auto* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+			throw std::system_error(errno, std::generic_category(), "mmap failed");
+
+		std::ignore = ::madvise(data, size, MADV_SEQUENTIAL);
+
+		return { static_cast<const char*>(data), size };
+	}
+
+	void mapped_file::unmap() noexcept
+	{
+		if (data_ != nullptr)
+			std::ignore = ::munmap(const_cast<char*>(data_), size_);
+	}
+#endif
+
+	mapped_file::mapped_file(mapped_file&& other) noexcept
+		: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+	{
+	}
+
+	mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+	{
+		if (this != &other) {
+			unmap();
+			data_ = std::exchange(other.data_, nullptr);
+			size_ = std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+	mapped_file::~mapped_file()
+	{
+		unmap();
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace playground
+{
+	/// Read-only memory mapping of a whole file, backed by `MapViewOfFile` on Windows and `mmap` elsewhere.
+	/// Empty files are valid and produce an empty view without a mapping.
+	class mapped_file {
+	public:
+		/// Throws `std::system_error` when the file cannot be opened or mapped
+		[[nodiscard]] static mapped_file open(const char* path);
+
+		mapped_file() noexcept = default;
+		mapped_file(mapped_file&& other) noexcept;
+		mapped_file& operator=(mapped_file&& other) noexcept;
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+		~mapped_file();
+
+		[[nodiscard]] std::string_view view() const noexcept { return { data_, size_ }; }
+		[[nodiscard]] const char* data() const noexcept { return data_; }
+		[[nodiscard]] size_t size() const noexcept { return size_; }
+
+	private:
+		mapped_file(const char* data, size_t size) noexcept : data_(data), size_(size) {}
+
+		void unmap() noexcept;
+
+		const char* data_ = nullptr;
+		size_t size_ = 0;
+	};
+}
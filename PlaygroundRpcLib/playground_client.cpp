@@ -1,8 +1,23 @@
 #include "playground_client.h"
+#include "playground_server.h"
 
+#include "call_metrics.h"
+#include "call_trace.h"
+#include "content_hash.h"
+#include "deadline.h"
+#include "delta_codec.h"
+#include "delta_sessions.h"
 #include "../Common/defer.h"
 
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <random>
+#include <shared_mutex>
+#include <stdexcept>
 #include <system_error>
+#include <unordered_map>
 
 /// __try __except must be in a function that does not require unwinding
 template <class Fn, class ...Args> requires std::invocable<Fn, Args...>
@@ -16,20 +31,208 @@ template <class Fn, class ...Args> requires std::invocable<Fn, Args...>
 	}
 }
 
+namespace
+{
+	std::atomic<bool> force_rpc{ false };
+	std::atomic<std::uint64_t> in_process_calls;
+
+	/// Endpoint of each binding made by `connect`, dropped again by `free_binding`, so the in-process
+	/// check needs neither the runtime nor a parse, and a reused handle value does not inherit it
+	struct binding_endpoints {
+		std::shared_mutex mutex;
+		std::unordered_map<handle_t, std::string> endpoints;
+	};
+
+	[[nodiscard]] binding_endpoints& get_binding_endpoints()
+	{
+		static binding_endpoints bindings;
+		return bindings;
+	}
+
+	/// Whether this process listens on the binding's endpoint. Bindings not made by `connect` always
+	/// take the full path.
+	[[nodiscard]] bool runs_in_process(handle_t handle) noexcept
+	{
+		using namespace playground;
+
+		if (force_rpc.load(std::memory_order_relaxed) || !server::is_serving())
+			return false;
+
+		auto& bindings = get_binding_endpoints();
+		std::shared_lock lock(bindings.mutex);
+
+		const auto it = bindings.endpoints.find(handle);
+		return it != bindings.endpoints.end() && server::serves_endpoint(it->second);
+	}
+
+	/// Calls the server routine directly when this process serves the endpoint. The `s_` and `c_`
+	/// routines share a signature, and out buffers come from `MIDL_user_allocate` on both paths,
+	/// so the caller frees them the same way.
+	template <class Fn, class ...Args>
+	[[nodiscard]] error_status_t call_server(bool in_process, Fn local, Fn remote, handle_t handle, Args&&... args)
+	{
+		if (in_process) {
+			in_process_calls.fetch_add(1, std::memory_order_relaxed);
+			return local(handle, std::forward<Args>(args)...);
+		}
+
+		return rpc_exception_wrapper(remote, handle, std::forward<Args>(args)...);
+	}
+
+	template <class Fn, class ...Args>
+	[[nodiscard]] error_status_t call_server(Fn local, Fn remote, handle_t handle, Args&&... args)
+	{
+		return call_server(runs_in_process(handle), local, remote, handle, std::forward<Args>(args)...);
+	}
+
+	std::atomic<std::uint64_t> dedup_hits;
+	std::atomic<std::uint64_t> dedup_misses;
+	std::atomic<std::uint64_t> dedup_bytes_saved;
+
+	[[nodiscard]] std::uint64_t rpc_string_length(const char* out_str) noexcept
+	{
+		return out_str != nullptr ? std::strlen(out_str) : 0;
+	}
+
+	[[nodiscard]] std::string take_rpc_string(char* out_str)
+	{
+		if (out_str == nullptr)
+			return {};
+
+		defer(MIDL_user_free(out_str));
+		return std::string(out_str);
+	}
+
+	/// Takes the narrowest procedure carrying what the call needs. A server built before one was
+	/// added rejects it with RPC_S_PROCNUM_OUT_OF_RANGE, and the call is sent again with less: the
+	/// server-side deadline skip, then the trace link are lost.
+	[[nodiscard]] error_status_t call_pass_and_get_string(bool in_process, handle_t handle, const deadline_context& context, const char* str, char** out_str)
+	{
+		if (context.deadline_ns != 0) {
+			const auto status = call_server(in_process, s_pass_and_get_string_deadline, c_pass_and_get_string_deadline, handle, &context, str, out_str);
+			if (status != RPC_S_PROCNUM_OUT_OF_RANGE)
+				return status;
+		}
+
+		if (context.call_id != 0) {
+			const call_context traced{ .call_id = context.call_id };
+			const auto status = call_server(in_process, s_pass_and_get_string_ctx, c_pass_and_get_string_ctx, handle, &traced, str, out_str);
+			if (status != RPC_S_PROCNUM_OUT_OF_RANGE)
+				return status;
+		}
+
+		return call_server(in_process, s_pass_and_get_string, c_pass_and_get_string, handle, str, out_str);
+	}
+
+	/// Returns the reply still in its RPC buffer, for the caller to take within the `take_reply` phase
+	[[nodiscard]] playground::rpc_result<char*> send_pass_and_get_string(handle_t handle, const deadline_context& context, const char* str, playground::metrics::call_scope& call)
+	{
+		using namespace playground::deadline;
+
+		char* out_str = nullptr;
+		error_status_t status = ERROR_SUCCESS;
+		{
+			playground::trace::span span("c_pass_and_get_string", context.call_id);
+
+			const bool in_process = runs_in_process(handle);
+			if (has_passed(context.deadline_ns)) {
+				status = ERROR_TIMEOUT;
+			}
+			else if (context.deadline_ns != 0 && !in_process) {
+				cancel_scope cancel(context.deadline_ns);
+				status = call_pass_and_get_string(in_process, handle, context, str, &out_str);
+
+				if (status == RPC_S_CALL_CANCELLED && cancel.cancelled()) {
+					count(counter::client_cancelled);
+					status = ERROR_TIMEOUT;
+				}
+			}
+			else {
+				status = call_pass_and_get_string(in_process, handle, context, str, &out_str);
+
+				// Nothing can interrupt a callback running on this thread, a reply it returns after
+				// the deadline is dropped instead
+				if (status == ERROR_SUCCESS && has_passed(context.deadline_ns)) {
+					MIDL_user_free(out_str);
+					out_str = nullptr;
+					status = ERROR_TIMEOUT;
+				}
+			}
+		}
+		call.finish(status, rpc_string_length(out_str));
+
+		if (status == ERROR_TIMEOUT)
+			count(counter::client_expired);
+
+		if (status != ERROR_SUCCESS)
+			return std::unexpected(playground::rpc_error{ status, "c_pass_and_get_string" });
+
+		return out_str;
+	}
+
+	/// The in-process path runs the server routine on this thread, which may still throw
+	[[nodiscard]] playground::rpc_error to_rpc_error(const char* operation) noexcept
+	{
+		try {
+			throw;
+		}
+		catch (const std::bad_alloc&) {
+			return { ERROR_NOT_ENOUGH_MEMORY, operation };
+		}
+		catch (const std::system_error& e) {
+			return { static_cast<std::uint32_t>(e.code().value()), operation };
+		}
+		catch (...) {
+			return { ERROR_INTERNAL_ERROR, operation };
+		}
+	}
+
+	/// `deadline_ns` of 0 for none
+	[[nodiscard]] playground::rpc_result<std::string> try_pass_and_get_string_until(handle_t handle, const char* str, std::uint64_t deadline_ns) noexcept
+	{
+		using namespace playground;
+
+		try {
+			const deadline_context context{
+				.call_id = trace::is_enabled() ? trace::new_call_id() : 0,
+				.deadline_ns = deadline_ns,
+			};
+
+			metrics::call_scope call(metrics::side::client, metrics::method::pass_and_get_string, std::strlen(str), context.call_id);
+			auto out_str = send_pass_and_get_string(handle, context, str, call);
+			if (!out_str)
+				return std::unexpected(out_str.error());
+
+			metrics::phase_scope phase(metrics::phase::take_reply, context.call_id);
+			return take_rpc_string(*out_str);
+		}
+		catch (...) {
+			return std::unexpected(to_rpc_error("pass_and_get_string"));
+		}
+	}
+}
+
 namespace playground::client
 {
-	handle_t connect()
+	handle_t connect(const char* endpoint)
+	{
+		return value_or_throw(try_connect(endpoint));
+	}
+
+	rpc_result<handle_t> try_connect(const char* endpoint) noexcept
 	{
+		trace::span span("connect", 0);
+
 		RPC_CSTR string_binding = nullptr;
 		if (auto status = RpcStringBindingComposeA(
 			nullptr /* uuid */,
 			rpc_str_cast(PROTOCOL_SEQUENCE),
 			nullptr /* network address */,
-			rpc_str_cast(ENDPOINT),
+			rpc_str_cast(endpoint),
 			nullptr /* options */,
 			&string_binding); status != RPC_S_OK)
 		{
-			throw std::system_error(status, std::system_category(), "RpcStringBindingComposeA failed");
+			return std::unexpected(rpc_error{ static_cast<std::uint32_t>(status), "RpcStringBindingComposeA" });
 		}
 
 		defer(std::ignore = RpcStringFreeA(&string_binding));
@@ -37,24 +240,383 @@ namespace playground::client
 		handle_t binding = nullptr;
 		if (auto status = RpcBindingFromStringBindingA(string_binding, &binding); status != RPC_S_OK)
 		{
-			throw std::system_error(status, std::system_category(), "RpcBindingFromStringBindingA failed");
+			return std::unexpected(rpc_error{ static_cast<std::uint32_t>(status), "RpcBindingFromStringBindingA" });
+		}
+
+		try {
+			auto& bindings = get_binding_endpoints();
+			std::scoped_lock lock(bindings.mutex);
+			bindings.endpoints.insert_or_assign(binding, endpoint);
+		}
+		catch (const std::bad_alloc&) {
+			std::ignore = RpcBindingFree(&binding);
+			return std::unexpected(rpc_error{ ERROR_NOT_ENOUGH_MEMORY, "connect" });
 		}
 
 		return binding;
 	}
 
+	void free_binding(handle_t& handle) noexcept
+	{
+		if (handle == nullptr)
+			return;
+
+		{
+			auto& bindings = get_binding_endpoints();
+			std::scoped_lock lock(bindings.mutex);
+			bindings.endpoints.erase(handle);
+		}
+
+		std::ignore = RpcBindingFree(&handle);
+	}
+
+	void set_force_rpc(bool force) noexcept
+	{
+		force_rpc.store(force, std::memory_order_relaxed);
+	}
+
+	bool calls_in_process(handle_t handle) noexcept
+	{
+		return runs_in_process(handle);
+	}
+
+	std::uint64_t get_in_process_calls() noexcept
+	{
+		return in_process_calls.load(std::memory_order_relaxed);
+	}
+
 	std::string pass_and_get_string(handle_t handle, const std::string& str)
 	{
-		char* out_str = nullptr;
-		auto status = rpc_exception_wrapper(c_pass_and_get_string, handle, str.c_str(), &out_str);
+		return value_or_throw(try_pass_and_get_string(handle, str.c_str()));
+	}
+
+	rpc_result<std::string> try_pass_and_get_string(handle_t handle, const char* str) noexcept
+	{
+		return try_pass_and_get_string_until(handle, str, 0);
+	}
+
+	std::string pass_and_get_string(handle_t handle, const std::string& str, deadline::clock::time_point until)
+	{
+		return value_or_throw(try_pass_and_get_string(handle, str.c_str(), until));
+	}
+
+	rpc_result<std::string> try_pass_and_get_string(handle_t handle, const char* str, deadline::clock::time_point until) noexcept
+	{
+		return try_pass_and_get_string_until(handle, str, deadline::to_ns(until));
+	}
+
+	std::string pass_and_get_string(handle_t handle, const std::string& str, const retry_policy& policy)
+	{
+		return value_or_throw(try_pass_and_get_string(handle, str.c_str(), policy));
+	}
+
+	rpc_result<std::string> try_pass_and_get_string(handle_t handle, const char* str, const retry_policy& policy) noexcept
+	{
+		return with_retries(policy, [&] { return try_pass_and_get_string(handle, str); });
+	}
+
+	size_t pass_and_get_string_into(handle_t handle, const char* str, std::span<char> buffer)
+	{
+		return value_or_throw(try_pass_and_get_string_into(handle, str, buffer));
+	}
+
+	rpc_result<size_t> try_pass_and_get_string_into(handle_t handle, const char* str, std::span<char> buffer) noexcept
+	{
+		try {
+			const deadline_context context{ .call_id = trace::is_enabled() ? trace::new_call_id() : 0, .deadline_ns = 0 };
+
+			metrics::call_scope call(metrics::side::client, metrics::method::pass_and_get_string, std::strlen(str), context.call_id);
+			auto out_str = send_pass_and_get_string(handle, context, str, call);
+			if (!out_str)
+				return std::unexpected(out_str.error());
+
+			metrics::phase_scope phase(metrics::phase::take_reply, context.call_id);
+
+			if (*out_str == nullptr) {
+				if (!buffer.empty())
+					buffer[0] = '\0';
+				return 0;
+			}
+
+			defer(MIDL_user_free(*out_str));
+
+			const size_t length = std::strlen(*out_str);
+			if (length < buffer.size())
+				std::memcpy(buffer.data(), *out_str, length + 1);
+
+			return length;
+		}
+		catch (...) {
+			return std::unexpected(to_rpc_error("pass_and_get_string_into"));
+		}
+	}
+
+	std::vector<std::byte> pass_and_get_bytes(handle_t handle, std::span<const std::byte> data)
+	{
+		if (data.size() > std::numeric_limits<unsigned long>::max())
+			throw std::system_error(ERROR_BUFFER_OVERFLOW, std::system_category(), "pass_and_get_bytes payload is too large");
+
+		metrics::call_scope call(metrics::side::client, metrics::method::pass_and_get_bytes, data.size());
+
+		unsigned long out_size = 0;
+		byte* out_data = nullptr;
+		auto status = call_server(
+			s_pass_and_get_bytes,
+			c_pass_and_get_bytes,
+			handle,
+			static_cast<unsigned long>(data.size()),
+			reinterpret_cast<const byte*>(data.data()),
+			&out_size,
+			&out_data);
+		call.finish(status, out_size);
 
 		if (status != ERROR_SUCCESS)
-			throw std::system_error(status, std::system_category(), "c_pass_and_get_string failed");
+			throw std::system_error(status, std::system_category(), "c_pass_and_get_bytes failed");
 
-		if (out_str == nullptr)
+		if (out_data == nullptr)
 			return {};
 
-		defer(MIDL_user_free(out_str));
-		return std::string(out_str);
+		defer(MIDL_user_free(out_data));
+		const auto* first = reinterpret_cast<const std::byte*>(out_data);
+		return std::vector<std::byte>(first, first + out_size);
+	}
+
+	std::vector<std::byte> invoke(handle_t handle, std::uint32_t method_id, std::span<const std::byte> data)
+	{
+		if (data.size() > std::numeric_limits<unsigned long>::max())
+			throw std::system_error(ERROR_BUFFER_OVERFLOW, std::system_category(), "invoke payload is too large");
+
+		metrics::call_scope call(metrics::side::client, metrics::method::invoke, data.size());
+
+		unsigned long out_size = 0;
+		byte* out_data = nullptr;
+		auto status = call_server(
+			s_invoke,
+			c_invoke,
+			handle,
+			static_cast<unsigned long>(method_id),
+			static_cast<unsigned long>(data.size()),
+			reinterpret_cast<const byte*>(data.data()),
+			&out_size,
+			&out_data);
+		call.finish(status, out_size);
+
+		if (status != ERROR_SUCCESS)
+			throw std::system_error(status, std::system_category(), "c_invoke failed");
+
+		if (out_data == nullptr)
+			return {};
+
+		defer(MIDL_user_free(out_data));
+		const auto* first = reinterpret_cast<const std::byte*>(out_data);
+		return std::vector<std::byte>(first, first + out_size);
+	}
+
+	shard_pool::shard_pool(std::uint32_t shards)
+		: size_(shards)
+	{
+		if (shards == 0 || shards > MAX_SHARDS)
+			throw std::invalid_argument{ "shards must be between 1 and MAX_SHARDS" };
+
+		shards_ = std::make_unique<shard[]>(shards);
+
+		try {
+			for (std::uint32_t i = 0; i < shards; ++i)
+				shards_[i].handle = connect(shard_endpoint(i).c_str());
+		}
+		catch (...) {
+			free_bindings();
+			throw;
+		}
+	}
+
+	shard_pool::~shard_pool()
+	{
+		free_bindings();
+	}
+
+	std::string shard_pool::pass_and_get_string(std::uint64_t key, const std::string& str)
+	{
+		return call(shards_[jump_consistent_hash(key, size_)], str);
+	}
+
+	std::string shard_pool::pass_and_get_string(const std::string& str)
+	{
+		return call(least_outstanding(), str);
+	}
+
+	shard_pool::shard& shard_pool::least_outstanding() noexcept
+	{
+		// Rotating the starting point spreads ties, which are the common case under light load
+		const auto start = next_.fetch_add(1, std::memory_order_relaxed);
+
+		auto* best = &shards_[start % size_];
+		for (std::uint32_t i = 1; i < size_ && best->outstanding.load(std::memory_order_relaxed) != 0; ++i)
+		{
+			auto& candidate = shards_[(start + i) % size_];
+			if (candidate.outstanding.load(std::memory_order_relaxed) < best->outstanding.load(std::memory_order_relaxed))
+				best = &candidate;
+		}
+
+		return *best;
+	}
+
+	std::string shard_pool::call(shard& target, const std::string& str)
+	{
+		target.outstanding.fetch_add(1, std::memory_order_relaxed);
+		defer(target.outstanding.fetch_sub(1, std::memory_order_relaxed));
+
+		return client::pass_and_get_string(target.handle, str);
+	}
+
+	void shard_pool::free_bindings() noexcept
+	{
+		for (std::uint32_t i = 0; i < size_; ++i)
+		{
+			if (shards_[i].handle != nullptr)
+				free_binding(shards_[i].handle);
+		}
+	}
+
+	stream_stats stream_file(
+		handle_t handle,
+		const char* path,
+		const chunk_reader_options& options,
+		const std::function<void(std::span<const std::byte>)>& on_reply)
+	{
+		chunk_reader reader(path, options);
+		stream_stats stats;
+
+		// Reads of the following chunks are in flight while this one is transmitted
+		for (auto chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+		{
+			auto reply = pass_and_get_bytes(handle, chunk);
+
+			++stats.chunks;
+			stats.bytes += chunk.size();
+
+			if (on_reply)
+				on_reply(reply);
+		}
+
+		return stats;
+	}
+
+	std::string pass_and_get_string_dedup(handle_t handle, const std::string& str)
+	{
+		if (str.size() < DEDUP_MIN_SIZE)
+			return pass_and_get_string(handle, str);
+
+		const auto hash = hash_content(str);
+
+		boolean found = FALSE;
+		char* out_str = nullptr;
+		error_status_t status = ERROR_SUCCESS;
+		{
+			metrics::call_scope call(metrics::side::client, metrics::method::pass_hash_and_get_string, hash.size());
+			status = call_server(s_pass_hash_and_get_string, c_pass_hash_and_get_string, handle, hash.data(), &found, &out_str);
+			call.finish(status, rpc_string_length(out_str));
+		}
+
+		if (status != ERROR_SUCCESS)
+			throw std::system_error(status, std::system_category(), "c_pass_hash_and_get_string failed");
+
+		if (found) {
+			dedup_hits.fetch_add(1, std::memory_order_relaxed);
+			dedup_bytes_saved.fetch_add(str.size() - hash.size(), std::memory_order_relaxed);
+			return take_rpc_string(out_str);
+		}
+
+		dedup_misses.fetch_add(1, std::memory_order_relaxed);
+
+		metrics::call_scope call(metrics::side::client, metrics::method::pass_hashed_and_get_string, hash.size() + str.size());
+		status = call_server(s_pass_hashed_and_get_string, c_pass_hashed_and_get_string, handle, hash.data(), str.c_str(), &out_str);
+		call.finish(status, rpc_string_length(out_str));
+
+		if (status != ERROR_SUCCESS)
+			throw std::system_error(status, std::system_category(), "c_pass_hashed_and_get_string failed");
+
+		return take_rpc_string(out_str);
+	}
+
+	dedup_stats get_dedup_stats()
+	{
+		return {
+			.hits = dedup_hits.load(std::memory_order_relaxed),
+			.misses = dedup_misses.load(std::memory_order_relaxed),
+			.bytes_saved = dedup_bytes_saved.load(std::memory_order_relaxed),
+		};
+	}
+
+	delta_session::delta_session(handle_t handle)
+		: handle_(handle)
+	{
+		std::random_device device;
+		id_ = (std::uint64_t{ device() } << 32) | device();
+	}
+
+	std::string delta_session::pass_and_get_string(const std::string& str)
+	{
+		std::uint32_t base_version = version_;
+		std::vector<std::byte> delta_bytes;
+
+		// Without a base there is nothing to encode against
+		if (base_version != 0)
+			delta_bytes = delta::encode(last_, str);
+
+		if (base_version == 0 || delta_bytes.size() >= str.size()) {
+			delta_bytes = delta::encode_full(str);
+			base_version = 0;
+		}
+
+		char* out_str = nullptr;
+		auto status = send(base_version, delta_bytes, &out_str);
+
+		if (status == ERROR_INVALID_DATA && base_version != 0) {
+			// The server dropped the session or lost track of it, start over with the full payload
+			++stats_.resyncs;
+			delta_bytes = delta::encode_full(str);
+			base_version = 0;
+			status = send(base_version, delta_bytes, &out_str);
+		}
+
+		if (status != ERROR_SUCCESS) {
+			version_ = 0;
+			last_.clear();
+			throw std::system_error(status, std::system_category(), "c_pass_delta_and_get_string failed");
+		}
+
+		if (base_version == 0) {
+			++stats_.full_sends;
+		}
+		else {
+			++stats_.delta_sends;
+			stats_.bytes_saved += str.size() - delta_bytes.size();
+		}
+
+		version_ = next_delta_version(base_version);
+		last_ = str;
+
+		return take_rpc_string(out_str);
+	}
+
+	error_status_t delta_session::send(std::uint32_t base_version, std::span<const std::byte> delta, char** out_str)
+	{
+		if (delta.size() > std::numeric_limits<unsigned long>::max())
+			return ERROR_BUFFER_OVERFLOW;
+
+		metrics::call_scope call(metrics::side::client, metrics::method::pass_delta_and_get_string, delta.size());
+
+		const auto status = call_server(
+			s_pass_delta_and_get_string,
+			c_pass_delta_and_get_string,
+			handle_,
+			id_,
+			base_version,
+			static_cast<unsigned long>(delta.size()),
+			reinterpret_cast<const byte*>(delta.data()),
+			out_str);
+
+		return call.finish(status, rpc_string_length(*out_str));
 	}
 }
@@ -1,12 +1,159 @@
 #pragma once
 
 #include "playground_rpc.h"
+#include "chunk_reader.h"
+#include "deadline.h"
+#include "retry.h"
+#include "rpc_error.h"
+#include "sharding.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace playground::client
 {
-	handle_t connect();
+	handle_t connect(const char* endpoint = ENDPOINT);
+
+	/// The `try_` functions report failures as values and never throw, for callers on a hot path
+	/// where failures are frequent enough that unwinding shows up. The other functions are built on
+	/// them and throw `std::system_error` with the same status.
+	[[nodiscard]] rpc_result<handle_t> try_connect(const char* endpoint = ENDPOINT) noexcept;
+
+	/// Frees a binding made by `connect` together with the endpoint recorded for the in-process
+	/// path. Use it in place of RpcBindingFree, the runtime may hand out the handle value again.
+	void free_binding(handle_t& handle) noexcept;
+
+	/// While this process serves the endpoint of a binding, calls on it go straight to the server
+	/// routines, without NDR marshalling or the transport. Forcing RPC keeps the full path, e.g. for
+	/// tests.
+	void set_force_rpc(bool force) noexcept;
+
+	/// Whether calls on `handle` currently take the in-process path
+	[[nodiscard]] bool calls_in_process(handle_t handle) noexcept;
+
+	/// Calls which took the in-process path
+	[[nodiscard]] std::uint64_t get_in_process_calls() noexcept;
 
 	std::string pass_and_get_string(handle_t handle, const std::string& str);
+
+	[[nodiscard]] rpc_result<std::string> try_pass_and_get_string(handle_t handle, const char* str) noexcept;
+
+	/// Fails with ERROR_TIMEOUT once `until` passes. A call still waiting for the server is cancelled,
+	/// the server skips the callback of a call which expired before dispatch, and the callback can
+	/// poll `server::is_call_cancelled`. On the in-process path the callback runs on the calling
+	/// thread and is not interrupted; a reply it returns after `until` is dropped.
+	std::string pass_and_get_string(handle_t handle, const std::string& str, deadline::clock::time_point until);
+	[[nodiscard]] rpc_result<std::string> try_pass_and_get_string(handle_t handle, const char* str, deadline::clock::time_point until) noexcept;
+
+	/// Retries transient failures with jittered backoff, see `with_retries`. Only for idempotent
+	/// callbacks, a retry may reach a server which already ran the call.
+	std::string pass_and_get_string(handle_t handle, const std::string& str, const retry_policy& policy);
+	[[nodiscard]] rpc_result<std::string> try_pass_and_get_string(handle_t handle, const char* str, const retry_policy& policy) noexcept;
+
+	/// Copies the reply straight from the RPC buffer into `buffer`, zero-terminated, without an
+	/// intermediate string. Returns the reply length; when that is not below `buffer.size()` nothing
+	/// is written, and the call has to be repeated with a larger buffer.
+	size_t pass_and_get_string_into(handle_t handle, const char* str, std::span<char> buffer);
+
+	[[nodiscard]] rpc_result<size_t> try_pass_and_get_string_into(handle_t handle, const char* str, std::span<char> buffer) noexcept;
+
+	/// Counted-bytes variant, the payload may contain zeros, e.g. a flat message from `flat_schema.h`
+	std::vector<std::byte> pass_and_get_bytes(handle_t handle, std::span<const std::byte> data);
+
+	/// Calls the handler registered under `method_id` on the server, see `dispatch_registry.h`
+	std::vector<std::byte> invoke(handle_t handle, std::uint32_t method_id, std::span<const std::byte> data);
+
+	/// Spreads calls over the shard endpoints of a server initialized with `shards`, with one binding
+	/// per shard. Safe to call from many threads at once.
+	class shard_pool {
+	public:
+		explicit shard_pool(std::uint32_t shards);
+		~shard_pool();
+
+		shard_pool(const shard_pool&) = delete;
+		shard_pool& operator=(const shard_pool&) = delete;
+
+		/// Calls with the same key go to the same shard, see `jump_consistent_hash`
+		std::string pass_and_get_string(std::uint64_t key, const std::string& str);
+
+		/// Calls the shard with the fewest calls of this pool in flight
+		std::string pass_and_get_string(const std::string& str);
+
+		[[nodiscard]] std::uint32_t size() const noexcept { return size_; }
+
+	private:
+		struct alignas(64) shard {
+			handle_t handle = nullptr;
+			std::atomic<std::uint32_t> outstanding{ 0 };
+		};
+
+		[[nodiscard]] shard& least_outstanding() noexcept;
+		std::string call(shard& target, const std::string& str);
+		void free_bindings() noexcept;
+
+		std::uint32_t size_ = 0;
+		std::unique_ptr<shard[]> shards_;
+		std::atomic<std::uint32_t> next_{ 0 };
+	};
+
+	struct stream_stats {
+		std::uint64_t chunks = 0;
+		std::uint64_t bytes = 0;
+	};
+
+	/// Sends a file chunk by chunk through `pass_and_get_bytes` while the following chunks are read
+	/// ahead, so the disk and the transport overlap. `on_reply` may be empty.
+	stream_stats stream_file(
+		handle_t handle,
+		const char* path,
+		const chunk_reader_options& options,
+		const std::function<void(std::span<const std::byte>)>& on_reply);
+
+	struct dedup_stats {
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+		std::uint64_t bytes_saved = 0;
+	};
+
+	/// Payloads below this size are sent as-is, a hash round trip would not pay off
+	constexpr size_t DEDUP_MIN_SIZE = 4 * 1024;
+
+	/// Sends the content hash first and the body only when the server does not have it stored
+	std::string pass_and_get_string_dedup(handle_t handle, const std::string& str);
+
+	dedup_stats get_dedup_stats();
+
+	struct delta_stats {
+		std::uint64_t delta_sends = 0;
+		std::uint64_t full_sends = 0;
+		std::uint64_t resyncs = 0;
+		std::uint64_t bytes_saved = 0;
+	};
+
+	/// Sends each payload as a delta against the previous payload of the session, or in full when
+	/// the delta would not be smaller. Calls of one session must not overlap.
+	class delta_session {
+	public:
+		/// The session does not own the binding handle
+		explicit delta_session(handle_t handle);
+
+		std::string pass_and_get_string(const std::string& str);
+
+		[[nodiscard]] const delta_stats& stats() const noexcept { return stats_; }
+
+	private:
+		error_status_t send(std::uint32_t base_version, std::span<const std::byte> delta, char** out_str);
+
+		handle_t handle_ = nullptr;
+		std::uint64_t id_ = 0;
+		std::uint32_t version_ = 0;
+		std::string last_;
+		delta_stats stats_;
+	};
 }
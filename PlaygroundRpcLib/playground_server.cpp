@@ -1,29 +1,85 @@
 #include "playground_server.h"
 
+#include "alloc_profiler.h"
+#include "call_metrics.h"
+#include "call_trace.h"
+#include "deadline.h"
+#include "delta_sessions.h"
 #include "../Common/defer.h"
 
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstring>
 #include <format>
+#include <limits>
+#include <span>
+#include <stdexcept>
 #include <system_error>
 #include <Windows.h>
 
+static std::atomic<bool> serving{ false };
+
+/// Shard endpoints listened on, they stay open across `terminate`
+static std::atomic<std::uint32_t> listening_shards{ 0 };
+
+static void use_endpoint(const char* endpoint)
+{
+	if (auto status = RpcServerUseProtseqEpA(
+		rpc_str_cast(playground::PROTOCOL_SEQUENCE),
+		RPC_C_PROTSEQ_MAX_REQS_DEFAULT,
+		rpc_str_cast(endpoint),
+		nullptr /* security descriptor */); status != RPC_S_OK)
+	{
+		throw std::system_error(status, std::system_category(), "RpcServerUseProtseqEpA failed");
+	}
+}
+
 static playground::callbacks& get_callbacks()
 {
 	static playground::callbacks callbacks;
 	return callbacks;
 }
 
+static playground::delta_session_store& get_delta_sessions()
+{
+	static playground::delta_session_store sessions(playground::server::MAX_DELTA_SESSIONS);
+	return sessions;
+}
+
+static playground::content_store& get_content_store()
+{
+	static playground::content_store store(playground::server::DEFAULT_CONTENT_STORE_BUDGET);
+	return store;
+}
+
+static playground::batch_dispatcher& get_batch_dispatcher()
+{
+	static playground::batch_dispatcher dispatcher([](char* reply) { CoTaskMemFree(reply); });
+	return dispatcher;
+}
+
+static playground::dispatch_registry& get_dispatch_registry()
+{
+	static playground::dispatch_registry registry;
+	return registry;
+}
+
 namespace playground::server
 {
-	void initialize(callbacks callbacks)
+	void initialize(callbacks callbacks, std::uint32_t shards)
 	{
-		if (auto status = RpcServerUseProtseqEpA(
-			rpc_str_cast(PROTOCOL_SEQUENCE),
-			RPC_C_PROTSEQ_MAX_REQS_DEFAULT,
-			rpc_str_cast(ENDPOINT),
-			nullptr /* security descriptor */); status != RPC_S_OK)
-		{
-			throw std::system_error(status, std::system_category(), "RpcServerUseProtseqEpA failed");
-		}
+		if (shards > MAX_SHARDS)
+			throw std::invalid_argument{ "too many shards" };
+
+		use_endpoint(ENDPOINT);
+
+		// Endpoints stay open until the process exits, `terminate` only stops dispatching to the interface
+		for (std::uint32_t shard = 0; shard < shards; ++shard)
+			use_endpoint(shard_endpoint(shard).c_str());
+
+		if (shards > listening_shards.load(std::memory_order_relaxed))
+			listening_shards.store(shards, std::memory_order_relaxed);
 
 		if (auto status = RpcServerRegisterIf3(
 			s_playground_interface_v1_0_s_ifspec,
@@ -39,33 +95,157 @@ namespace playground::server
 		}
 
 		get_callbacks() = callbacks;
+		serving.store(true, std::memory_order_release);
 	}
 
 	void terminate()
 	{
+		serving.store(false, std::memory_order_release);
 		get_callbacks() = {};
 
 		if (auto status = RpcServerUnregisterIf(s_playground_interface_v1_0_s_ifspec, nullptr, 0); status != RPC_S_OK) {
 			throw std::system_error(status, std::system_category(), "RpcServerUnregisterIf failed");
 		}
 	}
+
+	bool is_call_cancelled() noexcept
+	{
+		return deadline::server_call_cancelled();
+	}
+
+	bool is_serving() noexcept
+	{
+		return serving.load(std::memory_order_acquire);
+	}
+
+	bool serves_endpoint(std::string_view endpoint) noexcept
+	{
+		if (!is_serving())
+			return false;
+
+		if (endpoint == ENDPOINT)
+			return true;
+
+		// "playground_server_{shard}", see `shard_endpoint`
+		const std::string_view prefix = ENDPOINT;
+		if (!endpoint.starts_with(prefix) || endpoint.size() < prefix.size() + 2 || endpoint[prefix.size()] != '_')
+			return false;
+
+		const auto digits = endpoint.substr(prefix.size() + 1);
+		if (digits.size() > 1 && digits.front() == '0')
+			return false;
+
+		std::uint32_t shard = 0;
+		const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), shard);
+		return error == std::errc{} && end == digits.data() + digits.size() && shard < listening_shards.load(std::memory_order_relaxed);
+	}
+
+	void set_content_store_budget(size_t budget_bytes)
+	{
+		get_content_store().set_budget(budget_bytes);
+	}
+
+	content_store_stats get_content_store_stats()
+	{
+		return get_content_store().stats();
+	}
+
+	void set_batch_options(batch_options options)
+	{
+		get_batch_dispatcher().set_options(options);
+	}
+
+	batch_stats get_batch_stats()
+	{
+		return get_batch_dispatcher().stats();
+	}
+
+	bool register_method(std::uint32_t method_id, method_handler_t handler, void* context)
+	{
+		return get_dispatch_registry().register_method(method_id, { handler, context });
+	}
+
+	bool unregister_method(std::uint32_t method_id)
+	{
+		return get_dispatch_registry().unregister_method(method_id);
+	}
 }
 
-error_status_t s_pass_and_get_string(
-	/* [in] */ handle_t binding_handle,
-	/* [string][in] */ const char* str,
-	/* [string][out] */ char** out_str)
+/// Copies reply segments straight into the RPC out buffer, without concatenating them first
+static error_status_t gather_reply(const playground::callbacks& callbacks, std::uint64_t call_id, const char* str, char** out_str)
 {
-	std::ignore = binding_handle;
-	auto* str_local = get_callbacks().pass_and_get_string(str);
+	constexpr size_t max_segments = 16;
+	std::array<playground::reply_segment, max_segments> segments{};
+	void* context = nullptr;
+
+	size_t count = 0;
+	{
+		playground::metrics::phase_scope phase(playground::metrics::phase::callback, call_id);
+		count = callbacks.pass_and_get_string_gather(str, segments.data(), segments.size(), &context);
+	}
+
+	defer(if (callbacks.release_reply != nullptr) callbacks.release_reply(context));
+
+	if (count > segments.size())
+		return ERROR_INSUFFICIENT_BUFFER;
+
+	playground::metrics::phase_scope phase(playground::metrics::phase::reply_copy, call_id);
+
+	size_t buffer_size = 1;
+	for (const auto& segment : std::span{ segments.data(), count })
+		buffer_size += segment.size;
+
+	playground::alloc_profiler::site_scope site(playground::alloc_profiler::site::server_reply);
+	*out_str = static_cast<char*>(MIDL_user_allocate(buffer_size));
+	if (*out_str == nullptr)
+		return ERROR_NOT_ENOUGH_MEMORY;
+
+	char* cursor = *out_str;
+	for (const auto& segment : std::span{ segments.data(), count })
+	{
+		if (segment.size == 0)
+			continue;
+
+		std::memcpy(cursor, segment.data, segment.size);
+		cursor += segment.size;
+	}
+	*cursor = '\0';
+
+	return ERROR_SUCCESS;
+}
+
+static error_status_t dispatch_pass_and_get_string(std::uint64_t call_id, const char* str, char** out_str)
+{
+	if (const auto callbacks = get_callbacks(); callbacks.pass_and_get_string_gather != nullptr)
+		return gather_reply(callbacks, call_id, str, out_str);
+
+	char* str_local = nullptr;
+	{
+		playground::metrics::phase_scope phase(playground::metrics::phase::callback, call_id);
+		if (const auto batch = get_callbacks().pass_and_get_string_batch; batch != nullptr) {
+			// A failed batch fails each of its requests
+			try {
+				str_local = get_batch_dispatcher().call(batch, str);
+			}
+			catch (...) {
+				return ERROR_INTERNAL_ERROR;
+			}
+		}
+		else {
+			str_local = get_callbacks().pass_and_get_string(str);
+		}
+	}
 
 	if (str_local == nullptr)
 		return ERROR_SUCCESS;
 
 	defer(CoTaskMemFree(str_local));
 
+	playground::metrics::phase_scope phase(playground::metrics::phase::reply_copy, call_id);
+
 	const size_t buffer_size = std::strlen(str_local) + 1;
 
+	playground::alloc_profiler::site_scope site(playground::alloc_profiler::site::server_reply);
 	*out_str = static_cast<char*>(MIDL_user_allocate(buffer_size));
 	if (*out_str == nullptr)
 		return ERROR_NOT_ENOUGH_MEMORY;
@@ -79,3 +259,232 @@ error_status_t s_pass_and_get_string(
 
 	return ERROR_SUCCESS;
 }
+
+[[nodiscard]] static std::uint64_t reply_length(char** out_str) noexcept
+{
+	return *out_str != nullptr ? std::strlen(*out_str) : 0;
+}
+
+static error_status_t serve_pass_and_get_string(std::uint64_t call_id, std::uint64_t deadline_ns, const char* str, char** out_str)
+{
+	playground::trace::span span("s_pass_and_get_string", call_id);
+	playground::metrics::call_scope call(playground::metrics::side::server, playground::metrics::method::pass_and_get_string, std::strlen(str), call_id);
+
+	// The client gave up on it already, e.g. while the call waited for a worker thread
+	if (playground::deadline::has_passed(deadline_ns)) {
+		playground::deadline::count(playground::deadline::counter::server_skipped);
+		return call.finish(ERROR_TIMEOUT, 0);
+	}
+
+	playground::deadline::server_scope scope(deadline_ns);
+
+	const auto status = dispatch_pass_and_get_string(call_id, str, out_str);
+	return call.finish(status, reply_length(out_str));
+}
+
+error_status_t s_pass_and_get_string(
+	/* [in] */ handle_t binding_handle,
+	/* [string][in] */ const char* str,
+	/* [string][out] */ char** out_str)
+{
+	std::ignore = binding_handle;
+	return serve_pass_and_get_string(0, 0, str, out_str);
+}
+
+error_status_t s_pass_and_get_string_ctx(
+	/* [in] */ handle_t binding_handle,
+	/* [in] */ const call_context* context,
+	/* [string][in] */ const char* str,
+	/* [string][out] */ char** out_str)
+{
+	std::ignore = binding_handle;
+	return serve_pass_and_get_string(context->call_id, 0, str, out_str);
+}
+
+error_status_t s_pass_and_get_string_deadline(
+	/* [in] */ handle_t binding_handle,
+	/* [in] */ const deadline_context* context,
+	/* [string][in] */ const char* str,
+	/* [string][out] */ char** out_str)
+{
+	std::ignore = binding_handle;
+	return serve_pass_and_get_string(context->call_id, context->deadline_ns, str, out_str);
+}
+
+/// Moves a handler's `CoTaskMemAlloc` reply into the RPC out buffer
+static error_status_t copy_bytes_reply(std::uint8_t* data_local, std::size_t size_local, unsigned long* out_size, byte** out_data)
+{
+	if (data_local == nullptr)
+		return ERROR_SUCCESS;
+
+	defer(CoTaskMemFree(data_local));
+
+	if (size_local > std::numeric_limits<unsigned long>::max())
+		return ERROR_BUFFER_OVERFLOW;
+
+	if (size_local == 0)
+		return ERROR_SUCCESS;
+
+	playground::metrics::phase_scope phase(playground::metrics::phase::reply_copy, 0);
+	playground::alloc_profiler::site_scope site(playground::alloc_profiler::site::server_reply);
+	*out_data = static_cast<byte*>(MIDL_user_allocate(size_local));
+	if (*out_data == nullptr)
+		return ERROR_NOT_ENOUGH_MEMORY;
+
+	if (auto err = memcpy_s(*out_data, size_local, data_local, size_local); err != 0)
+	{
+		MIDL_user_free(*out_data);
+		*out_data = nullptr;
+		return ERROR_INTERNAL_ERROR;
+	}
+
+	*out_size = static_cast<unsigned long>(size_local);
+	return ERROR_SUCCESS;
+}
+
+static error_status_t dispatch_pass_and_get_bytes(unsigned long size, const byte* data, unsigned long* out_size, byte** out_data)
+{
+	*out_size = 0;
+
+	auto callback = get_callbacks().pass_and_get_bytes;
+	if (callback == nullptr)
+		return ERROR_CALL_NOT_IMPLEMENTED;
+
+	std::uint8_t* data_local = nullptr;
+	std::size_t size_local = 0;
+	{
+		playground::metrics::phase_scope phase(playground::metrics::phase::callback, 0);
+		callback(data, size, &data_local, &size_local);
+	}
+
+	return copy_bytes_reply(data_local, size_local, out_size, out_data);
+}
+
+static error_status_t dispatch_invoke(unsigned long method_id, unsigned long size, const byte* data, unsigned long* out_size, byte** out_data)
+{
+	*out_size = 0;
+
+	std::uint8_t* data_local = nullptr;
+	std::size_t size_local = 0;
+	error_status_t status = ERROR_SUCCESS;
+	{
+		playground::metrics::phase_scope phase(playground::metrics::phase::callback, 0);
+		status = get_dispatch_registry().invoke(method_id, data, size, &data_local, &size_local);
+	}
+
+	// A failing handler may still have allocated a reply
+	if (status != ERROR_SUCCESS) {
+		CoTaskMemFree(data_local);
+		return status;
+	}
+
+	return copy_bytes_reply(data_local, size_local, out_size, out_data);
+}
+
+error_status_t s_pass_and_get_bytes(
+	/* [in] */ handle_t binding_handle,
+	/* [in] */ unsigned long size,
+	/* [size_is][in] */ const byte* data,
+	/* [out] */ unsigned long* out_size,
+	/* [size_is][size_is][out] */ byte** out_data)
+{
+	std::ignore = binding_handle;
+	playground::metrics::call_scope call(playground::metrics::side::server, playground::metrics::method::pass_and_get_bytes, size);
+
+	const auto status = dispatch_pass_and_get_bytes(size, data, out_size, out_data);
+	return call.finish(status, *out_size);
+}
+
+error_status_t s_pass_hash_and_get_string(
+	/* [in] */ handle_t binding_handle,
+	/* [in] */ const byte hash[32],
+	/* [out] */ boolean* found,
+	/* [string][out] */ char** out_str)
+{
+	std::ignore = binding_handle;
+	playground::metrics::call_scope call(playground::metrics::side::server, playground::metrics::method::pass_hash_and_get_string, sizeof(playground::content_hash));
+
+	playground::content_hash key;
+	std::memcpy(key.data(), hash, key.size());
+
+	auto content = get_content_store().find(key);
+	*found = content != nullptr;
+
+	if (content == nullptr)
+		return call.finish(ERROR_SUCCESS, 0);
+
+	const auto status = dispatch_pass_and_get_string(0, content->c_str(), out_str);
+	return call.finish(status, reply_length(out_str));
+}
+
+error_status_t s_pass_hashed_and_get_string(
+	/* [in] */ handle_t binding_handle,
+	/* [in] */ const byte hash[32],
+	/* [string][in] */ const char* str,
+	/* [string][out] */ char** out_str)
+{
+	std::ignore = binding_handle;
+	playground::metrics::call_scope call(playground::metrics::side::server, playground::metrics::method::pass_hashed_and_get_string, sizeof(playground::content_hash) + std::strlen(str));
+
+	try {
+		auto content = std::make_shared<const std::string>(str);
+
+		// Never trust the client-provided hash, a mismatch would poison the store for everyone
+		const auto key = playground::hash_content(*content);
+		if (std::memcmp(key.data(), hash, key.size()) != 0)
+			return call.finish(ERROR_INVALID_DATA, 0);
+
+		get_content_store().insert(key, std::move(content));
+	}
+	catch (const std::bad_alloc&) {
+		return call.finish(ERROR_NOT_ENOUGH_MEMORY, 0);
+	}
+	catch (const std::system_error& e) {
+		return call.finish(static_cast<error_status_t>(e.code().value()), 0);
+	}
+
+	const auto status = dispatch_pass_and_get_string(0, str, out_str);
+	return call.finish(status, reply_length(out_str));
+}
+
+error_status_t s_pass_delta_and_get_string(
+	/* [in] */ handle_t binding_handle,
+	/* [in] */ unsigned hyper session_id,
+	/* [in] */ unsigned long base_version,
+	/* [in] */ unsigned long size,
+	/* [size_is][in] */ const byte* delta,
+	/* [string][out] */ char** out_str)
+{
+	std::ignore = binding_handle;
+	playground::metrics::call_scope call(playground::metrics::side::server, playground::metrics::method::pass_delta_and_get_string, size);
+
+	std::optional<std::string> payload;
+	try {
+		payload = get_delta_sessions().apply(session_id, base_version, std::as_bytes(std::span{ delta, size }));
+	}
+	catch (const std::bad_alloc&) {
+		return call.finish(ERROR_NOT_ENOUGH_MEMORY, 0);
+	}
+
+	// The client resends the full payload on this error
+	if (!payload)
+		return call.finish(ERROR_INVALID_DATA, 0);
+
+	const auto status = dispatch_pass_and_get_string(0, payload->c_str(), out_str);
+	return call.finish(status, reply_length(out_str));
+}
+
+error_status_t s_invoke(
+	/* [in] */ handle_t binding_handle,
+	/* [in] */ unsigned long method_id,
+	/* [in] */ unsigned long size,
+	/* [size_is][in] */ const byte* data,
+	/* [out] */ unsigned long* out_size,
+	/* [size_is][size_is][out] */ byte** out_data)
+{
+	std::ignore = binding_handle;
+	playground::metrics::call_scope call(playground::metrics::side::server, playground::metrics::method::invoke, size);
+
+	const auto status = dispatch_invoke(method_id, size, data, out_size, out_data);
+	return call.finish(status, *out_size);
+}
@@ -1,10 +1,46 @@
 #pragma once
 
 #include "playground_rpc.h"
+#include "batch_dispatcher.h"
 #include "callbacks.h"
+#include "dispatch_registry.h"
+#include "content_store.h"
+#include "sharding.h"
+
+#include <string_view>
 
 namespace playground::server
 {
-	void initialize(callbacks callbacks);
+	/// Listens on `ENDPOINT` and on `shards` endpoints named by `shard_endpoint`. Each endpoint is a
+	/// port with its own connections and request queue; the worker threads are the RPC runtime's,
+	/// shared by all endpoints of the process.
+	void initialize(callbacks callbacks, std::uint32_t shards = 0);
 	void terminate();
+
+	/// For a callback polling while it works: whether the deadline of the call it serves passed, or
+	/// the client cancelled the call. Always false for calls without a deadline.
+	[[nodiscard]] bool is_call_cancelled() noexcept;
+
+	/// Whether this process serves the endpoint, between `initialize` and `terminate`
+	[[nodiscard]] bool is_serving() noexcept;
+
+	/// Whether `endpoint` is `ENDPOINT` or one of the shard endpoints this process serves
+	[[nodiscard]] bool serves_endpoint(std::string_view endpoint) noexcept;
+
+	/// Budget of the content store backing `pass_hash_and_get_string`
+	constexpr size_t DEFAULT_CONTENT_STORE_BUDGET = 64 * 1024 * 1024;
+
+	/// Sessions of `pass_delta_and_get_string` kept with their last payload
+	constexpr size_t MAX_DELTA_SESSIONS = 1024;
+
+	void set_content_store_budget(size_t budget_bytes);
+	content_store_stats get_content_store_stats();
+
+	/// Micro-batching of `callbacks::pass_and_get_string_batch`
+	void set_batch_options(batch_options options);
+	batch_stats get_batch_stats();
+
+	/// Handlers of the generic `invoke` entry point, see `dispatch_registry`
+	bool register_method(std::uint32_t method_id, method_handler_t handler, void* context);
+	bool unregister_method(std::uint32_t method_id);
 }
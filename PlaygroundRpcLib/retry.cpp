@@ -0,0 +1,116 @@
+#include "retry.h"
+
+#include "token_bucket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <Windows.h>
+
+namespace
+{
+	constexpr double RETRY_BURST = 10;
+
+	std::atomic<std::uint64_t> retries{ 0 };
+	std::atomic<std::uint64_t> exhausted{ 0 };
+	std::atomic<std::uint64_t> over_budget{ 0 };
+
+	playground::token_bucket& get_budget() noexcept
+	{
+		static playground::token_bucket budget(playground::client::DEFAULT_RETRY_BUDGET_RATIO, RETRY_BURST);
+		return budget;
+	}
+
+	/// Uniform in [0, 1), xorshift per thread, the jitter does not need more
+	[[nodiscard]] double next_random() noexcept
+	{
+		thread_local std::uint64_t random_state = 0;
+
+		if (random_state == 0)
+			random_state = (reinterpret_cast<std::uintptr_t>(&random_state) ^ GetTickCount64()) | 1;
+
+		random_state ^= random_state << 13;
+		random_state ^= random_state >> 7;
+		random_state ^= random_state << 17;
+		return static_cast<double>(random_state >> 11) * 0x1.0p-53;
+	}
+
+	[[nodiscard]] std::chrono::microseconds backoff(const playground::client::retry_policy& policy, std::uint32_t retry) noexcept
+	{
+		const auto shift = std::min<std::uint32_t>(retry, 30);
+		const auto ceiling = std::min(policy.base_backoff * (std::int64_t{ 1 } << shift), policy.max_backoff);
+
+		// Full jitter
+		return std::chrono::microseconds{ static_cast<std::int64_t>(next_random() * static_cast<double>(ceiling.count())) };
+	}
+}
+
+namespace playground::client
+{
+	bool is_transient(std::uint32_t status) noexcept
+	{
+		switch (status) {
+		case RPC_S_SERVER_TOO_BUSY:
+		case RPC_S_SERVER_UNAVAILABLE:
+		case RPC_S_CALL_FAILED_DNE:
+		case RPC_S_OUT_OF_RESOURCES:
+		case EPT_S_NOT_REGISTERED:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	void set_retry_budget(double ratio) noexcept
+	{
+		get_budget().set_ratio(ratio);
+	}
+
+	retry_stats get_retry_stats() noexcept
+	{
+		return {
+			.retries = retries.load(std::memory_order_relaxed),
+			.exhausted = exhausted.load(std::memory_order_relaxed),
+			.over_budget = over_budget.load(std::memory_order_relaxed),
+		};
+	}
+
+	void reset_retries() noexcept
+	{
+		auto& budget = get_budget();
+		budget.set_ratio(DEFAULT_RETRY_BUDGET_RATIO);
+		budget.refill();
+
+		retries.store(0, std::memory_order_relaxed);
+		exhausted.store(0, std::memory_order_relaxed);
+		over_budget.store(0, std::memory_order_relaxed);
+	}
+
+	namespace detail
+	{
+		void count_call() noexcept
+		{
+			get_budget().deposit();
+		}
+
+		bool wait_for_retry(const retry_policy& policy, std::uint32_t attempt, std::uint32_t status) noexcept
+		{
+			if (!is_transient(status))
+				return false;
+
+			if (attempt >= policy.max_attempts) {
+				exhausted.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			if (!get_budget().try_withdraw()) {
+				over_budget.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			retries.fetch_add(1, std::memory_order_relaxed);
+			std::this_thread::sleep_for(backoff(policy, attempt - 1));
+			return true;
+		}
+	}
+}
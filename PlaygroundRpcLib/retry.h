@@ -0,0 +1,70 @@
+#pragma once
+
+#include "rpc_error.h"
+
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace playground::client
+{
+	struct retry_policy {
+		/// Including the first attempt
+		std::uint32_t max_attempts = 3;
+
+		/// The wait before retry n, counted from 1, is drawn uniformly from zero up to `base_backoff`
+		/// * 2^(n - 1), capped by `max_backoff`, so clients failing together do not retry together
+		std::chrono::microseconds base_backoff{ 1'000 };
+		std::chrono::microseconds max_backoff{ 100'000 };
+	};
+
+	struct retry_stats {
+		std::uint64_t retries = 0;
+
+		/// Calls which still failed transiently after `max_attempts`
+		std::uint64_t exhausted = 0;
+
+		/// Retries not made because the process ran out of retry budget
+		std::uint64_t over_budget = 0;
+	};
+
+	/// Share of calls made with a retry policy which may be retried, across the process
+	inline constexpr double DEFAULT_RETRY_BUDGET_RATIO = 0.1;
+
+	/// Failures where the server did not run the call and a later attempt may succeed, e.g.
+	/// RPC_S_SERVER_TOO_BUSY or RPC_S_SERVER_UNAVAILABLE. RPC_S_CALL_FAILED is not one of them,
+	/// the call may have run.
+	[[nodiscard]] bool is_transient(std::uint32_t status) noexcept;
+
+	/// Caps retries at `ratio` of the calls made with a retry policy, plus a small burst
+	void set_retry_budget(double ratio) noexcept;
+	[[nodiscard]] retry_stats get_retry_stats() noexcept;
+
+	/// Back to a full budget at `DEFAULT_RETRY_BUDGET_RATIO` and zero stats, e.g. between tests
+	void reset_retries() noexcept;
+
+	namespace detail
+	{
+		/// Every call earns part of a retry
+		void count_call() noexcept;
+
+		/// Whether to make attempt `attempt` + 1 after a failure with `status`, after the backoff
+		[[nodiscard]] bool wait_for_retry(const retry_policy& policy, std::uint32_t attempt, std::uint32_t status) noexcept;
+	}
+
+	/// Makes `attempt`, which returns an `rpc_result`, again after transient failures while the
+	/// policy and the process-wide retry budget allow
+	template <class Fn> requires std::invocable<Fn&>
+	[[nodiscard]] std::invoke_result_t<Fn&> with_retries(const retry_policy& policy, Fn&& attempt) noexcept(std::is_nothrow_invocable_v<Fn&>)
+	{
+		detail::count_call();
+
+		for (std::uint32_t n = 1;; ++n)
+		{
+			auto result = attempt();
+			if (result || !detail::wait_for_retry(policy, n, result.error().status))
+				return result;
+		}
+	}
+}
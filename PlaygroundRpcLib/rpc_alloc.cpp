@@ -1,14 +1,15 @@
-﻿#include <cstdlib>
+﻿#include "alloc_profiler.h"
+
 #include <rpc.h>
 
 _Must_inspect_result_
 _Ret_maybenull_ _Post_writable_byte_size_(size)
 void* __RPC_USER MIDL_user_allocate(_In_ size_t size)
 {
-	return std::malloc(size);
+	return playground::alloc_profiler::allocate(size);
 }
 
 void __RPC_USER MIDL_user_free(_Pre_maybenull_ _Post_invalid_ void* ptr)
 {
-	std::free(ptr);
+	playground::alloc_profiler::free(ptr);
 }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <system_error>
+
+namespace playground
+{
+	/// Failure of a non-throwing client call
+	struct rpc_error {
+		/// System or RPC status code
+		std::uint32_t status = 0;
+
+		/// Static name of what failed, e.g. "c_pass_and_get_string"
+		const char* operation = "";
+	};
+
+	template <class T>
+	using rpc_result = std::expected<T, rpc_error>;
+
+	/// The throwing API is built on the non-throwing one, with the same `system_error` as before
+	[[noreturn]] inline void throw_rpc_error(const rpc_error& error)
+	{
+		throw std::system_error(static_cast<int>(error.status), std::system_category(), std::string(error.operation) + " failed");
+	}
+
+	template <class T>
+	[[nodiscard]] T value_or_throw(rpc_result<T>&& result)
+	{
+		if (!result)
+			throw_rpc_error(result.error());
+
+		return std::move(*result);
+	}
+}
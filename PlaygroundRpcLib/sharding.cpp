@@ -0,0 +1,28 @@
+#include "sharding.h"
+
+#include "playground_rpc.h"
+
+#include <format>
+
+namespace playground
+{
+	std::string shard_endpoint(std::uint32_t shard)
+	{
+		return std::format("{}_{}", ENDPOINT, shard);
+	}
+
+	std::uint32_t jump_consistent_hash(std::uint64_t key, std::uint32_t buckets) noexcept
+	{
+		std::int64_t bucket = -1;
+		std::int64_t next = 0;
+
+		while (next < buckets)
+		{
+			bucket = next;
+			key = key * 2862933555777941757ULL + 1;
+			next = static_cast<std::int64_t>(static_cast<double>(bucket + 1) * (static_cast<double>(1LL << 31) / static_cast<double>((key >> 33) + 1)));
+		}
+
+		return static_cast<std::uint32_t>(bucket);
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/// A server may listen on numbered shard endpoints besides `ENDPOINT`, so concurrent clients do
+/// not all queue on one port. Clients pick a shard per call, see `client::shard_pool`.
+namespace playground
+{
+	constexpr std::uint32_t MAX_SHARDS = 64;
+
+	/// "playground_server_{shard}"
+	[[nodiscard]] std::string shard_endpoint(std::uint32_t shard);
+
+	/// Jump consistent hash (Lamping, Veach): spreads keys evenly over `buckets`, and growing from
+	/// n to n + 1 buckets moves only 1/(n + 1) of the keys. `buckets` must not be 0.
+	[[nodiscard]] std::uint32_t jump_consistent_hash(std::uint64_t key, std::uint32_t buckets) noexcept;
+}
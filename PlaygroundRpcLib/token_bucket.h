@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace playground
+{
+	/// Budget of extra work relative to regular work: every `deposit` adds `ratio` of a token and
+	/// an extra attempt takes a whole one, so extra attempts stay below `ratio` of the regular ones
+	/// plus the initial `burst`. Refilled by traffic rather than by time, an idle process does not
+	/// build up a budget beyond `burst`.
+	class token_bucket {
+	public:
+		token_bucket(double ratio, double burst) noexcept
+			: per_deposit_(to_milli_tokens(ratio)),
+			capacity_(static_cast<std::int64_t>(std::max(burst, 1.0) * SCALE)),
+			milli_tokens_(capacity_)
+		{
+		}
+
+		/// Applies to later deposits, the tokens already in the bucket stay
+		void set_ratio(double ratio) noexcept
+		{
+			per_deposit_.store(to_milli_tokens(ratio), std::memory_order_relaxed);
+		}
+
+		void deposit() noexcept
+		{
+			const auto per_deposit = per_deposit_.load(std::memory_order_relaxed);
+			auto current = milli_tokens_.load(std::memory_order_relaxed);
+			while (current < capacity_
+				&& !milli_tokens_.compare_exchange_weak(current, std::min(current + per_deposit, capacity_), std::memory_order_relaxed))
+			{
+			}
+		}
+
+		[[nodiscard]] bool try_withdraw() noexcept
+		{
+			auto current = milli_tokens_.load(std::memory_order_relaxed);
+			while (current >= SCALE)
+			{
+				if (milli_tokens_.compare_exchange_weak(current, current - SCALE, std::memory_order_relaxed))
+					return true;
+			}
+
+			return false;
+		}
+
+		/// Back to the initial `burst`
+		void refill() noexcept
+		{
+			milli_tokens_.store(capacity_, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] double tokens() const noexcept
+		{
+			return static_cast<double>(milli_tokens_.load(std::memory_order_relaxed)) / SCALE;
+		}
+
+	private:
+		static constexpr std::int64_t SCALE = 1000;
+
+		[[nodiscard]] static std::int64_t to_milli_tokens(double ratio) noexcept
+		{
+			return static_cast<std::int64_t>(std::max(ratio, 0.0) * SCALE);
+		}
+
+		std::atomic<std::int64_t> per_deposit_;
+		std::int64_t capacity_;
+		std::atomic<std::int64_t> milli_tokens_;
+	};
+}
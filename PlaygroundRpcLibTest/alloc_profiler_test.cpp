@@ -0,0 +1,53 @@
+#include "test.h"
+
+#include "../PlaygroundRpcLib/alloc_profiler.h"
+
+#include <cstddef>
+#include <thread>
+
+namespace
+{
+	using playground::alloc_profiler::site;
+
+	void allocate_once(size_t size)
+	{
+		playground::alloc_profiler::site_scope scope(site::server_reply);
+		playground::alloc_profiler::free(playground::alloc_profiler::allocate(size));
+	}
+}
+
+PLAYGROUND_TEST(alloc_profiler_sample_all_counts_exactly)
+{
+	playground::alloc_profiler::reset();
+	playground::alloc_profiler::set_sample_interval(playground::alloc_profiler::SAMPLE_ALL);
+
+	for (size_t i = 0; i < 10; ++i)
+		allocate_once(100);
+
+	const auto stats = playground::alloc_profiler::stats(site::server_reply);
+	playground::alloc_profiler::set_sample_interval(0);
+
+	CHECK(stats.allocations == 10);
+	CHECK(stats.bytes == 1000);
+	CHECK(stats.frees == 10);
+	CHECK(stats.live_bytes == 0);
+}
+
+PLAYGROUND_TEST(alloc_profiler_does_not_overweight_short_lived_threads)
+{
+	// One small allocation per thread, about one in a thousand is sampled with a weight of about a thousand
+	constexpr size_t threads = 2000;
+	constexpr size_t size = 64;
+
+	playground::alloc_profiler::reset();
+	playground::alloc_profiler::set_sample_interval(64 * 1024);
+
+	for (size_t i = 0; i < threads; ++i)
+		std::jthread(allocate_once, size).join();
+
+	const auto stats = playground::alloc_profiler::stats(site::server_reply);
+	playground::alloc_profiler::set_sample_interval(0);
+
+	// Sampling the first allocation of every thread would estimate about a thousand times too many
+	CHECK(stats.allocations < 20 * threads);
+}
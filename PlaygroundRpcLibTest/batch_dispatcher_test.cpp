@@ -0,0 +1,110 @@
+#include "test.h"
+
+#include "../PlaygroundRpcLib/batch_dispatcher.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr size_t REQUESTS = 8;
+
+	std::atomic<size_t> freed_replies{ 0 };
+
+	[[nodiscard]] char* copy_string(const std::string& str)
+	{
+		auto* copy = static_cast<char*>(std::malloc(str.size() + 1));
+		std::memcpy(copy, str.c_str(), str.size() + 1);
+		return copy;
+	}
+
+	void free_reply(char* reply)
+	{
+		freed_replies.fetch_add(1);
+		std::free(reply);
+	}
+
+	void echo_batch(const playground::batch_request* requests, char** replies, std::size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			replies[i] = copy_string("Batch: " + std::string(requests[i].str, requests[i].size));
+	}
+
+	/// Answers the first request, then fails the whole batch
+	void failing_batch(const playground::batch_request* requests, char** replies, std::size_t count)
+	{
+		if (count > 0)
+			replies[0] = copy_string(requests[0].str);
+
+		throw std::runtime_error("batch failed");
+	}
+}
+
+PLAYGROUND_TEST(batch_dispatcher_groups_concurrent_requests)
+{
+	playground::batch_dispatcher dispatcher(&free_reply);
+	dispatcher.set_options({ .window = std::chrono::milliseconds(50), .max_batch_size = REQUESTS });
+
+	std::vector<std::string> replies(REQUESTS);
+	{
+		std::vector<std::jthread> threads;
+		for (size_t i = 0; i < REQUESTS; ++i)
+		{
+			threads.emplace_back([&, i] {
+				const auto request = std::to_string(i);
+				auto* reply = dispatcher.call(&echo_batch, request.c_str());
+				replies[i] = reply;
+				std::free(reply);
+			});
+		}
+	}
+
+	for (size_t i = 0; i < REQUESTS; ++i)
+		CHECK(replies[i] == "Batch: " + std::to_string(i));
+
+	CHECK(dispatcher.stats().requests == REQUESTS);
+	CHECK(dispatcher.stats().batches < REQUESTS);
+}
+
+PLAYGROUND_TEST(batch_dispatcher_throwing_callback_fails_every_request)
+{
+	playground::batch_dispatcher dispatcher(&free_reply);
+	dispatcher.set_options({ .window = std::chrono::milliseconds(50), .max_batch_size = REQUESTS });
+
+	const auto freed_before = freed_replies.load();
+	std::atomic<size_t> failed{ 0 };
+	std::atomic<size_t> answered{ 0 };
+	{
+		// Followers used to wait forever for a batch whose leader had thrown
+		std::vector<std::jthread> threads;
+		for (size_t i = 0; i < REQUESTS; ++i)
+		{
+			threads.emplace_back([&] {
+				try {
+					std::free(dispatcher.call(&failing_batch, "request"));
+					answered.fetch_add(1);
+				}
+				catch (const std::runtime_error&) {
+					failed.fetch_add(1);
+				}
+			});
+		}
+	}
+
+	CHECK(failed.load() == REQUESTS);
+	CHECK(answered.load() == 0);
+
+	// One reply per batch was set before the callback threw
+	CHECK(freed_replies.load() - freed_before == dispatcher.stats().batches);
+
+	// A failed batch leaves the dispatcher usable
+	auto* reply = dispatcher.call(&echo_batch, "after");
+	CHECK(std::string(reply) == "Batch: after");
+	std::free(reply);
+}
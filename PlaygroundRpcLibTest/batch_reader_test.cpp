@@ -0,0 +1,79 @@
+#include "test.h"
+
+#include "../PlaygroundRpcLib/batch_reader.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	struct packed_result {
+		std::unique_ptr<std::byte[]> buffer;
+		playground::packed_files_header header;
+		std::vector<playground::packed_file_entry> entries;
+
+		[[nodiscard]] std::string_view content(size_t i) const
+		{
+			return { reinterpret_cast<const char*>(buffer.get()) + entries[i].offset, entries[i].size };
+		}
+	};
+
+	[[nodiscard]] packed_result read_packed(const std::vector<std::string>& paths, size_t queue_depth)
+	{
+		std::vector<const char*> raw_paths;
+		for (const auto& path : paths)
+			raw_paths.push_back(path.c_str());
+
+		packed_result result;
+		result.buffer.reset(playground::read_files_packed(
+			raw_paths,
+			queue_depth,
+			[](size_t size) { return new std::byte[size]; },
+			[](std::byte* data) { delete[] data; }));
+
+		std::memcpy(&result.header, result.buffer.get(), sizeof(result.header));
+		result.entries.resize(result.header.count);
+		if (!result.entries.empty())
+			std::memcpy(result.entries.data(), result.buffer.get() + sizeof(result.header), result.entries.size() * sizeof(playground::packed_file_entry));
+		return result;
+	}
+}
+
+PLAYGROUND_TEST(batch_reader_reads_files_in_order)
+{
+	const playground::test::temp_file first("first file");
+	const playground::test::temp_file empty("");
+	const playground::test::temp_file third(std::string(100'000, 'c'));
+
+	const auto result = read_packed({ first.path().string(), empty.path().string(), third.path().string() }, 2);
+
+	CHECK(result.header.count == 3);
+	CHECK(result.entries[0].status == 0 && result.content(0) == "first file");
+	CHECK(result.entries[1].status == 0 && result.entries[1].size == 0);
+	CHECK(result.entries[2].status == 0 && result.content(2) == std::string(100'000, 'c'));
+}
+
+PLAYGROUND_TEST(batch_reader_reports_missing_file)
+{
+	const playground::test::temp_file first("before");
+	const playground::test::temp_file last("after");
+
+	const auto result = read_packed({ first.path().string(), "playground-test-missing-file.bin", last.path().string() }, 4);
+
+	CHECK(result.header.count == 3);
+	CHECK(result.entries[0].status == 0 && result.content(0) == "before");
+	CHECK(result.entries[1].status != 0 && result.entries[1].size == 0);
+	CHECK(result.entries[2].status == 0 && result.content(2) == "after");
+}
+
+PLAYGROUND_TEST(batch_reader_empty_batch)
+{
+	const auto result = read_packed({}, 4);
+
+	CHECK(result.header.count == 0);
+	CHECK(result.header.total_size == sizeof(playground::packed_files_header));
+}
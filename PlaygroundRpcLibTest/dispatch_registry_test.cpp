@@ -0,0 +1,84 @@
+#include "test.h"
+
+#include "../PlaygroundRpcLib/dispatch_registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace
+{
+	constexpr std::uint32_t METHOD = 7;
+
+	struct gate {
+		std::atomic<bool> entered{ false };
+		std::atomic<bool> release{ false };
+		std::atomic<bool> returned{ false };
+	};
+
+	std::uint32_t blocking_handler(void* context, const std::uint8_t*, std::size_t, std::uint8_t**, std::size_t*)
+	{
+		auto& g = *static_cast<gate*>(context);
+		g.entered = true;
+		while (!g.release)
+			std::this_thread::yield();
+		g.returned = true;
+		return 0;
+	}
+
+	struct self_unregistering {
+		playground::dispatch_registry* registry = nullptr;
+		bool unregistered = false;
+	};
+
+	std::uint32_t unregistering_handler(void* context, const std::uint8_t*, std::size_t, std::uint8_t**, std::size_t*)
+	{
+		auto& self = *static_cast<self_unregistering*>(context);
+		self.unregistered = self.registry->unregister_method(METHOD);
+		return 0;
+	}
+}
+
+PLAYGROUND_TEST(dispatch_registry_unregister_waits_for_running_calls)
+{
+	playground::dispatch_registry registry;
+	gate g;
+	CHECK(registry.register_method(METHOD, { &blocking_handler, &g }));
+
+	std::atomic<std::uint32_t> status{ UINT32_MAX };
+	std::jthread call([&] {
+		std::uint8_t* out = nullptr;
+		std::size_t out_size = 0;
+		status = registry.invoke(METHOD, nullptr, 0, &out, &out_size);
+	});
+	while (!g.entered)
+		std::this_thread::yield();
+
+	std::jthread release([&] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		g.release = true;
+	});
+
+	CHECK(registry.unregister_method(METHOD));
+	CHECK(g.returned);
+	call.join();
+	CHECK(status == 0);
+
+	std::uint8_t* out = nullptr;
+	std::size_t out_size = 0;
+	CHECK(registry.invoke(METHOD, nullptr, 0, &out, &out_size) != 0);
+}
+
+PLAYGROUND_TEST(dispatch_registry_handler_unregisters_itself)
+{
+	playground::dispatch_registry registry;
+	self_unregistering self{ &registry };
+	CHECK(registry.register_method(METHOD, { &unregistering_handler, &self }));
+
+	std::uint8_t* out = nullptr;
+	std::size_t out_size = 0;
+	CHECK(registry.invoke(METHOD, nullptr, 0, &out, &out_size) == 0);
+	CHECK(self.unregistered);
+	CHECK(registry.invoke(METHOD, nullptr, 0, &out, &out_size) != 0);
+}
@@ -0,0 +1,85 @@
+#include "test.h"
+
+#include "../PlaygroundRpcLib/file_cache.h"
+
+#include <filesystem>
+#include <string>
+#include <tuple>
+
+PLAYGROUND_TEST(file_cache_serves_unchanged_file)
+{
+	const playground::test::temp_file file("cached content");
+	playground::file_cache cache(playground::DEFAULT_FILE_CACHE_BUDGET);
+
+	const auto first = cache.get(file.path().string().c_str());
+	const auto second = cache.get(file.path().string().c_str());
+
+	CHECK(*first == "cached content");
+	CHECK(first == second);
+	CHECK(cache.stats().hits == 1);
+	CHECK(cache.stats().misses == 1);
+}
+
+PLAYGROUND_TEST(file_cache_keys_by_canonical_path)
+{
+	const playground::test::temp_file file("one entry");
+	playground::file_cache cache(playground::DEFAULT_FILE_CACHE_BUDGET);
+
+	const auto directory = file.path().parent_path();
+	const auto detour = directory / ".." / directory.filename() / "." / file.path().filename();
+
+	std::ignore = cache.get(file.path().string().c_str());
+	std::ignore = cache.get(detour.string().c_str());
+
+	// A link to the directory only resolves to the same entry on the file system, not lexically
+	const auto link = directory / ("playground-test-link-" + file.path().stem().string());
+	std::error_code error;
+	std::filesystem::create_directory_symlink(directory, link, error);
+	if (!error) {
+		std::ignore = cache.get((link / file.path().filename()).string().c_str());
+		std::filesystem::remove(link, error);
+	}
+
+	CHECK(cache.stats().entries == 1);
+	CHECK(cache.stats().misses == 1);
+}
+
+PLAYGROUND_TEST(file_cache_follows_retargeted_link)
+{
+	const playground::test::temp_file first("first target");
+	const playground::test::temp_file second("the second target");
+	playground::file_cache cache(playground::DEFAULT_FILE_CACHE_BUDGET);
+
+	const auto link = first.path().parent_path() / ("playground-test-link-" + first.path().stem().string());
+	std::error_code error;
+	std::filesystem::create_symlink(first.path(), link, error);
+	if (error)
+		return;
+
+	// Served through the remembered path on the second lookup
+	CHECK(*cache.get(link.string().c_str()) == "first target");
+	CHECK(*cache.get(link.string().c_str()) == "first target");
+	CHECK(cache.stats().hits == 1);
+
+	std::filesystem::remove(link);
+	std::filesystem::create_symlink(second.path(), link, error);
+	const auto retargeted = error ? nullptr : cache.get(link.string().c_str());
+	std::filesystem::remove(link, error);
+
+	CHECK(retargeted != nullptr && *retargeted == "the second target");
+	CHECK(cache.stats().entries == 2);
+}
+
+PLAYGROUND_TEST(file_cache_evicts_over_budget)
+{
+	const playground::test::temp_file first(std::string(600, 'a'));
+	const playground::test::temp_file second(std::string(600, 'b'));
+	playground::file_cache cache(1000);
+
+	std::ignore = cache.get(first.path().string().c_str());
+	std::ignore = cache.get(second.path().string().c_str());
+
+	CHECK(cache.stats().entries == 1);
+	CHECK(cache.stats().evictions == 1);
+	CHECK(cache.stats().bytes <= 1000);
+}
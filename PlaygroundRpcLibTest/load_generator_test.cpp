@@ -0,0 +1,111 @@
+#include "test.h"
+
+#include "../PlaygroundLoad/load_generator.h"
+#include "../PlaygroundLoad/service_time.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	/// One connection per server thread at half the pool's capacity, requests never queue
+	[[nodiscard]] load::load_options unsaturated()
+	{
+		return {
+			.rate = 250.0,
+			.duration = 200ms,
+			.warmup = 20ms,
+			.connections = 1,
+			.arrival = load::arrival_process::constant,
+		};
+	}
+
+	/// Four connections each asking for what the one server thread can do alone
+	[[nodiscard]] load::load_options saturated()
+	{
+		auto options = unsaturated();
+		options.rate = 2000.0;
+		options.connections = 4;
+		return options;
+	}
+
+	/// Every request takes 2 ms of CPU on the server
+	[[nodiscard]] load::service_time fixed_service_time()
+	{
+		return *load::service_time::parse("const:2000");
+	}
+
+	/// Corrected latency counts from the intended send time, which never follows the actual one
+	void check_corrected_covers_service(const load::load_result& result)
+	{
+		for (const double percentile : { 50.0, 90.0, 99.0, 100.0 })
+			CHECK(result.latency.value_at_percentile(percentile) >= result.service.value_at_percentile(percentile));
+
+		CHECK(result.latency.max >= result.service.max);
+	}
+}
+
+PLAYGROUND_TEST(service_time_parses_valid_specs)
+{
+	using kind = load::service_time::kind;
+
+	const auto none = load::service_time::parse("none");
+	CHECK(none && none->type == kind::none);
+
+	const auto constant = load::service_time::parse("const:150");
+	CHECK(constant && constant->type == kind::constant && constant->a == 150.0);
+
+	const auto uniform = load::service_time::parse("uniform:10:20.5");
+	CHECK(uniform && uniform->type == kind::uniform && uniform->a == 10.0 && uniform->b == 20.5);
+
+	const auto exponential = load::service_time::parse("exp:40");
+	CHECK(exponential && exponential->type == kind::exponential && exponential->a == 40.0);
+
+	const auto lognormal = load::service_time::parse("lognormal:100:0.5");
+	CHECK(lognormal && lognormal->type == kind::lognormal && lognormal->a == 100.0 && lognormal->b == 0.5);
+
+	const auto bimodal = load::service_time::parse("bimodal:10:1000:0.01");
+	CHECK(bimodal && bimodal->type == kind::bimodal && bimodal->a == 10.0 && bimodal->b == 1000.0 && bimodal->p == 0.01);
+
+	std::mt19937_64 rng{ 1 };
+	CHECK(constant->sample(rng) == 150us);
+	CHECK(none->sample(rng) == 0ns);
+}
+
+PLAYGROUND_TEST(service_time_rejects_invalid_specs)
+{
+	for (const auto* spec : { "", "const", "const:", "const:-1", "const:1x", "const:1:2", "none:1", "uniform:10",
+		"exp:mean", "lognormal:100", "bimodal:10:1000", "gamma:1" })
+	{
+		CHECK(!load::service_time::parse(spec));
+	}
+}
+
+PLAYGROUND_TEST(run_load_corrects_latency_below_capacity)
+{
+	const auto transport = load::make_local_transport(1, fixed_service_time());
+	const auto result = load::run_load(*transport, unsaturated());
+
+	CHECK(result.sent > 0);
+	CHECK(result.errors == 0);
+	CHECK(result.latency.total == result.sent);
+	CHECK(result.service.value_at_percentile(50) >= std::uint64_t{ 2'000'000 });
+
+	check_corrected_covers_service(result);
+}
+
+PLAYGROUND_TEST(run_load_counts_late_requests_when_saturated)
+{
+	const auto transport = load::make_local_transport(1, fixed_service_time());
+	const auto result = load::run_load(*transport, saturated());
+
+	CHECK(result.sent > 0);
+	CHECK(result.errors == 0);
+	CHECK(result.late > 0);
+
+	// The backlog grows over the whole run while each request only waits for the other connections
+	check_corrected_covers_service(result);
+	CHECK(result.latency.value_at_percentile(99) > result.service.value_at_percentile(99));
+}
@@ -0,0 +1,73 @@
+#include "test.h"
+
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+// Runs every test case, or those whose name contains the first argument
+
+namespace playground::test
+{
+	std::vector<test_case>& registry()
+	{
+		static std::vector<test_case> cases;
+		return cases;
+	}
+
+	void check(bool condition, std::string_view expression, std::source_location where)
+	{
+		if (!condition)
+			throw failure{ std::string(where.file_name()) + ":" + std::to_string(where.line()) + ": CHECK(" + std::string(expression) + ") failed" };
+	}
+
+	temp_file::temp_file(std::string_view content)
+	{
+		static std::atomic<unsigned> counter{ 0 };
+		path_ = std::filesystem::temp_directory_path() / ("playground-test-" + std::to_string(counter.fetch_add(1)) + ".bin");
+
+		std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+		out.write(content.data(), static_cast<std::streamsize>(content.size()));
+		if (!out)
+			throw failure{ "cannot write " + path_.string() };
+	}
+
+	temp_file::~temp_file()
+	{
+		std::error_code ignored;
+		std::filesystem::remove(path_, ignored);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::string_view filter = argc > 1 ? argv[1] : "";
+
+	int run = 0;
+	int failed = 0;
+
+	for (const auto& test : playground::test::registry())
+	{
+		if (!test.name.contains(filter))
+			continue;
+
+		++run;
+		try {
+			test.run();
+			std::printf("[ ok   ] %.*s\n", static_cast<int>(test.name.size()), test.name.data());
+		}
+		catch (const playground::test::failure& f) {
+			++failed;
+			std::printf("[ FAIL ] %.*s: %s\n", static_cast<int>(test.name.size()), test.name.data(), f.message.c_str());
+		}
+		catch (const std::exception& e) {
+			++failed;
+			std::printf("[ FAIL ] %.*s: unexpected exception: %s\n", static_cast<int>(test.name.size()), test.name.data(), e.what());
+		}
+	}
+
+	std::printf("%d of %d tests passed\n", run - failed, run);
+	return failed == 0 ? 0 : 1;
+}
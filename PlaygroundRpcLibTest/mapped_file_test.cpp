@@ -0,0 +1,104 @@
+#include "test.h"
+
+#include "../PlaygroundRpcLib/mapped_file.h"
+
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	[[nodiscard]] size_t page_size()
+	{
+#ifdef _WIN32
+		SYSTEM_INFO info{};
+		GetSystemInfo(&info);
+		return info.dwPageSize;
+#else
+		return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	[[nodiscard]] std::string pattern(size_t size)
+	{
+		std::string content(size, '\0');
+		for (size_t i = 0; i < size; ++i)
+			content[i] = static_cast<char>('a' + i % 26);
+		return content;
+	}
+}
+
+PLAYGROUND_TEST(mapped_file_maps_whole_file)
+{
+	const auto content = pattern(10'000);
+	const playground::test::temp_file file(content);
+
+	const auto mapped = playground::mapped_file::open(file.path().string().c_str());
+
+	CHECK(mapped.size() == content.size());
+	CHECK(mapped.view() == content);
+}
+
+PLAYGROUND_TEST(mapped_file_empty_file_has_empty_view)
+{
+	const playground::test::temp_file file("");
+
+	const auto mapped = playground::mapped_file::open(file.path().string().c_str());
+
+	CHECK(mapped.data() == nullptr);
+	CHECK(mapped.view().empty());
+}
+
+PLAYGROUND_TEST(mapped_file_ending_on_page_boundary)
+{
+	// Nothing readable follows the view, only its own bytes may be touched
+	for (const size_t pages : { 1, 3 })
+	{
+		const auto content = pattern(pages * page_size());
+		const playground::test::temp_file file(content);
+
+		const auto mapped = playground::mapped_file::open(file.path().string().c_str());
+
+		CHECK(mapped.size() == content.size());
+		CHECK(mapped.view() == content);
+		CHECK(mapped.view().back() == content.back());
+	}
+}
+
+PLAYGROUND_TEST(mapped_file_move_transfers_view)
+{
+	const auto content = pattern(100);
+	const playground::test::temp_file file(content);
+
+	auto first = playground::mapped_file::open(file.path().string().c_str());
+	auto second = std::move(first);
+
+	CHECK(first.data() == nullptr);
+	CHECK(first.size() == 0);
+	CHECK(second.view() == content);
+
+	first = std::move(second);
+	CHECK(second.data() == nullptr);
+	CHECK(first.view() == content);
+}
+
+PLAYGROUND_TEST(mapped_file_missing_file_throws)
+{
+	bool thrown = false;
+	try {
+		std::ignore = playground::mapped_file::open("playground-test-missing-file.bin");
+	}
+	catch (const std::system_error&) {
+		thrown = true;
+	}
+
+	CHECK(thrown);
+}
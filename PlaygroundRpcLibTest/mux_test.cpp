@@ -0,0 +1,156 @@
+#include "test.h"
+
+#include "../Common/defer.h"
+#include "../PlaygroundLoad/mux.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	/// Holds back handlers until opened
+	class gate {
+	public:
+		void open()
+		{
+			{
+				std::scoped_lock lock(mutex_);
+				open_ = true;
+			}
+			opened_.notify_all();
+		}
+
+		void wait()
+		{
+			std::unique_lock lock(mutex_);
+			opened_.wait(lock, [&] { return open_; });
+		}
+
+	private:
+		std::mutex mutex_;
+		std::condition_variable opened_;
+		bool open_ = false;
+	};
+
+	[[nodiscard]] std::string echo(std::string_view request)
+	{
+		return "Echo: " + std::string(request);
+	}
+
+	[[nodiscard]] bool throws(std::future<std::string>& future)
+	{
+		try {
+			std::ignore = future.get();
+			return false;
+		}
+		catch (const std::runtime_error&) {
+			return true;
+		}
+	}
+}
+
+PLAYGROUND_TEST(mux_replies_complete_out_of_order)
+{
+	gate slow_done;
+	load::mux::server server(2, [&](std::string_view request) {
+		if (request == "slow")
+			slow_done.wait();
+		return echo(request);
+	});
+	defer(slow_done.open());
+
+	auto [client_end, server_end] = load::mux::make_memory_pipe();
+	server.serve(std::move(server_end));
+	load::mux::client client(std::move(client_end));
+
+	auto slow = client.call("slow");
+	auto fast = client.call("fast");
+
+	// The reply to the later request overtakes the earlier one on the same stream
+	CHECK(fast.get() == "Echo: fast");
+	CHECK(slow.wait_for(0s) == std::future_status::timeout);
+	CHECK(client.in_flight() == 1);
+
+	slow_done.open();
+	CHECK(slow.get() == "Echo: slow");
+	CHECK(client.in_flight() == 0);
+}
+
+PLAYGROUND_TEST(mux_many_concurrent_calls_share_one_stream)
+{
+	constexpr size_t THREADS = 8;
+	constexpr size_t CALLS = 200;
+
+	load::mux::server server(4, echo);
+
+	auto [client_end, server_end] = load::mux::make_memory_pipe();
+	server.serve(std::move(server_end));
+	load::mux::client client(std::move(client_end));
+
+	std::vector<std::vector<std::future<std::string>>> futures(THREADS);
+	{
+		std::vector<std::jthread> callers;
+		for (size_t t = 0; t < THREADS; ++t)
+		{
+			callers.emplace_back([&, t] {
+				for (size_t i = 0; i < CALLS; ++i)
+					futures[t].push_back(client.call(std::to_string(t) + "/" + std::to_string(i)));
+			});
+		}
+	}
+
+	// Every reply reaches the call it answers, whatever order they completed in
+	for (size_t t = 0; t < THREADS; ++t)
+	{
+		for (size_t i = 0; i < CALLS; ++i)
+			CHECK(futures[t][i].get() == "Echo: " + std::to_string(t) + "/" + std::to_string(i));
+	}
+
+	CHECK(client.in_flight() == 0);
+}
+
+PLAYGROUND_TEST(mux_client_destroyed_with_calls_pending)
+{
+	gate replies;
+	load::mux::server server(2, [&](std::string_view request) {
+		replies.wait();
+		return echo(request);
+	});
+	defer(replies.open());
+
+	auto [client_end, server_end] = load::mux::make_memory_pipe();
+	server.serve(std::move(server_end));
+
+	std::vector<std::future<std::string>> futures;
+	std::promise<bool> callback_failed;
+	{
+		load::mux::client client(std::move(client_end));
+
+		for (const auto* request : { "a", "b", "c" })
+			futures.push_back(client.call(request));
+
+		client.call("d", [&](std::string, std::exception_ptr error) { callback_failed.set_value(error != nullptr); });
+		CHECK(client.in_flight() == 4);
+	}
+
+	// Every call fails rather than waiting for a reply that can no longer arrive
+	for (auto& future : futures)
+		CHECK(throws(future));
+
+	CHECK(callback_failed.get_future().get());
+
+	// The server writes the late replies into the closed stream and goes on
+	replies.open();
+}
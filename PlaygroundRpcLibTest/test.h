@@ -0,0 +1,52 @@
+#pragma once
+
+#include <filesystem>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal test runner for the parts of PlaygroundRpcLib which build on any platform
+
+namespace playground::test
+{
+	struct test_case {
+		std::string_view name;
+		void (*run)();
+	};
+
+	[[nodiscard]] std::vector<test_case>& registry();
+
+	struct registrar {
+		registrar(std::string_view name, void (*run)()) { registry().push_back({ name, run }); }
+	};
+
+	/// Thrown by a failed `CHECK`, ends the test case
+	struct failure {
+		std::string message;
+	};
+
+	void check(bool condition, std::string_view expression, std::source_location where = std::source_location::current());
+
+	/// A file in the temp directory, removed again at scope exit
+	class temp_file {
+	public:
+		explicit temp_file(std::string_view content);
+		~temp_file();
+
+		temp_file(const temp_file&) = delete;
+		temp_file& operator=(const temp_file&) = delete;
+
+		[[nodiscard]] const std::filesystem::path& path() const noexcept { return path_; }
+
+	private:
+		std::filesystem::path path_;
+	};
+}
+
+#define PLAYGROUND_TEST(name) \
+	static void name(); \
+	static const playground::test::registrar name##_registrar(#name, name); \
+	static void name()
+
+#define CHECK(condition) playground::test::check(static_cast<bool>(condition), #condition)